@@ -6,18 +6,34 @@ Othello by Arnaud
 *****************
 
 Use keyboard keys:
-Arrows, Ctrl-Arrows, Enter, Space Bar, F1 (help)
+Arrows, Ctrl-Arrows, Enter, Space Bar, U (undo), R (redo), S (save), L (load), F1 (help)
 
 syntax:
-othello <board_size> <player_start> <processors> <monte_carlo> <display_score> <input_mode> <display_modifs>
+othello <board_size> <player_start> <processors> <monte_carlo> <display_score> <input_mode> <display_modifs> <ai_mode> <seed> <move_time> <game_time> <endgame> <hash_size> <book> <rollout_depth> <eval> <ponder> <telemetry> <game_file> <pruning>
 
-<board_size>		the size of the board					(default = 8, must be an even number >= 4)
+<board_size>		the size of the board					(default = 8, must be an even number from 4 to 16)
 <player_start>		player starts the game (YES/NO)				(default = YES)
 <processors>		number of core processors to use			(default = 4, cannot be lower than 1)
 <monte_carlo>		cumulated number of Monte Carlo paths for computer's AI	(default = 20000, cannot be lower than 100)
 <display_score>		display score assessed on last computer's move (YES/NO)	(default = YES)
 <input_mode>		K:Keyboard, M:mouse, B:both (K/M/B)			(default = B)
 <display_modifs>	display parameters screen on startup (YES/NO)		(default = YES)
+<ai_mode>		F:flat Monte Carlo, T:Monte Carlo tree search (F/T)	(default = F)
+<seed>			seed of the random numbers, 0 for a seed from the clock	(default = 0, a fixed seed replays the same games)
+<move_time>		computer's time per move in milliseconds		(default = 0, uses <monte_carlo> paths per move)
+<game_time>		computer's time for the whole game in seconds		(default = 0, no game clock; ignored if <move_time> is set)
+<endgame>		number of empty squares from which the computer plays a perfect endgame (default = 14, 0 to never solve)
+<hash_size>		memory of the table of positions already searched, in MB	(default = 64, 0 for no table)
+<book>			file of the opening book, built with othello_bench	(default = othello.book, - for no book; ignored if missing)
+<rollout_depth>		moves after which a Monte Carlo path is cut off and scored	(default = 0, paths played to the end)
+<eval>			file of the evaluator of the paths cut off, built with othello_bench	(default = othello.eval, - for none; ignored if missing)
+<ponder>		share of the CPU used by the computer on the player's time, in %	(default = 0, no pondering)
+<telemetry>		file to which a JSON line is appended per computer's move	(default = -, no telemetry)
+<game_file>		file of the game saved with S and loaded with L (e.g. f5d6c3)	(default = othello_game.txt)
+<pruning>		flat Monte Carlo drops the moves clearly worse than the best one (YES/NO)	(default = YES, NO for the same paths for all the moves)
+
+The compiled othello.exe takes the first 7 parameters; the others need othello.exe built
+again from the sources (see othello.cpp), and are then added to the othello line below
 
 Update parameters below to change the defaults
 
@@ -41,4 +57,3 @@ set monte_carlo=
 set display_score=
 set input_mode=
 set display_modifs=
-set display_modifs=
\ No newline at end of file
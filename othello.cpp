@@ -10,45 +10,52 @@
       [May 2017]
  
 
+The game is othello.cpp (Windows console), its display othello_display.cpp (the frame is drawn
+off-screen, only the changed cells are sent to the console) and the engine othello_engine.cpp.
+
 Compile options:
 g++ -Wall -c "%f" -std=c++11
 
 Link options (with local MinGW implementation):
-g++ -Wall -O3 -o "%e" "%f" -s -std=c++11 -lwinpthread
+g++ -Wall -O3 -o "%e" "%f" othello_display.cpp othello_engine.cpp -s -std=c++11 -lwinpthread
 
 Link options (for distribution):
-g++ -Wall -O3 -o "%e" "%f" -s -std=c++11 -static-libgcc -static-libstdc++ -static -lwinpthread
+g++ -Wall -O3 -o "%e" "%f" othello_display.cpp othello_engine.cpp -s -std=c++11 -static-libgcc -static-libstdc++ -static -lwinpthread
+
+Link options (debug, checks that the Monte Carlo paths make no heap allocation):
+g++ -Wall -O1 -g -o "%e" "%f" othello_display.cpp othello_engine.cpp -std=c++11 -DOTHELLO_DEBUG -lwinpthread
+
+Link options (telemetry counters of moves, flips and allocations, see <telemetry> in othello.bat):
+g++ -Wall -O3 -o "%e" "%f" othello_display.cpp othello_engine.cpp -s -std=c++11 -DOTHELLO_TELEMETRY -lwinpthread
+
+Benchmarks of the engine (any platform, see othello_bench.cpp):
+g++ -Wall -O3 -o othello_bench othello_bench.cpp othello_engine.cpp -std=c++11 -pthread
 
 */
 
 #include <vector>
 #include <iostream>
-#include <thread>
-#include <future>
 #include <conio.h>    // _getch()
 #include <iomanip>    // setw()
-#include <numeric>    // accumulate()
 #include <algorithm>  // find()
 #include <windows.h>  // Windows specific display
+#include <sstream>    // ostringstream
+#include <fstream>    // ifstream, ofstream (saved game)
+#include "othello_engine.h"
+#include "othello_display.h"
 
-enum class piece:char {EMPTY, X, O};
-
-int BOARD_SIZE = 8; // must be >= 4, and an even number
-int NUMBER_PROCESSOR = 4; // number of processor to use for parallel threading
-int NUMBER_MONTE_CARLO_PATH = 20000 / NUMBER_PROCESSOR; // AI: number of Monte Carlo path per 1 thread
 bool DISPLAY_COMPUTER_SCORE = true; // display score assessed for last computer's move
 piece PLAYER = piece::X; // player's piece
 piece COMPUTER = piece::O; // computer's piece
 bool PLAYER_START = true; // player stats the game
 char MODE_PLAY = 'B'; // 'M'ouse, 'K'eyboard, 'B'oth
+std::string GAME_FILE = "othello_game.txt"; // file of the game saved with <S>, loaded with <L> (transcript of the moves)
 
 const char DISPLAY_X = ' '; // display at the center of the X squares
 const char DISPLAY_O = ' '; // display at the center of the O squares
 const char DISPLAY_E = ' '; // display at the center of the EMPTY squares
 const char DISPLAY_S = (char) 219; // display at the center of the SELECTED square
 
-struct windows_console;
-
 const char *HELP =
 "How to play Othello\n"
 "----------------------\n"
@@ -69,89 +76,16 @@ const char *HELP =
 "\n"
 "At his turn, the computer will analyze all his possible moves, and make his play. "
 "The red dot indicates his current analysis, and will remain positioned "
-"on his played square.\n"
+"on his played square. While you think, the computer analyzes your likely moves, "
+"and answers faster when you play one of them.\n"
 "\n"
-"Press <U> to undo the last move, <F1> to display this help screen.\n"
+"Press <U> to undo the last move, <R> to redo it, <S> to save the game, <L> to load "
+"the game saved, <F1> to display this help screen.\n"
 "\n"
 "Enjoy!\n"
 "arnauddesombre@yahoo.com\n"
 "\n";
 
-inline int random_range(const int min, const int max) {
-	return min + rand() % (max - min + 1);
-}
-
-class othello_game {
-public:
-	// constructor
-	othello_game() {
-		srand(time(0));
-		for (int i = 0; i < BOARD_SIZE; i++) {
-			std::vector<piece> temp;
-			for (int j = 0; j < BOARD_SIZE; j++) {
-				temp.push_back(piece::EMPTY);
-			}
-			_othelloboard_piece.push_back(temp);
-			temp.clear();
-		}
-		// fill middle section
-		const int x = BOARD_SIZE / 2;
-		const int y = BOARD_SIZE / 2;
-		_othelloboard_piece[x][y] = piece::O;
-		_othelloboard_piece[x-1][y-1] = piece::O;
-		_othelloboard_piece[x-1][y] = piece::X;
-		_othelloboard_piece[x][y-1] = piece::X;
-	}
-	// copy constructor
-	othello_game(const othello_game& game) {
-		for (int i = 0; i < BOARD_SIZE; i++) {
-			std::vector<piece> temp;
-			for (int j = 0; j < BOARD_SIZE; j++) {
-				temp.push_back(game.get_othelloboard_piece(i, j));
-			}
-			_othelloboard_piece.push_back(temp);
-			temp.clear();
-		}
-	}
-	// getters
-	inline piece get_othelloboard_piece(const int row, const int col) const {return _othelloboard_piece[row][col];}
-	inline char get_othelloboard_piece_display(const int row, const int col) const {
-		switch (get_othelloboard_piece(row, col)) {
-			case piece::X:
-				return DISPLAY_X;
-			case piece::O:
-				return DISPLAY_O;
-			default:
-				return DISPLAY_E;
-			}
-	}
-	// setters
-	inline void set_othelloboard_piece(const int row, const int col, const piece p) {_othelloboard_piece[row][col] = p;}
-	// helper function
-	inline void make_move(windows_console& console, const int row, const int col, const piece p) {
-		set_othelloboard_piece(row, col, p);
-		execute_move(row, col, p, true, console);
-	}
-	inline void make_move(const int row, const int col, const piece p) {
-		set_othelloboard_piece(row, col, p);
-		execute_move(row, col, p);
-	}
-	// helper function prototypes
-	void print(windows_console& console, const int row, const int col, const bool player_turn, const double score);	
-	void score_move(const int rnd, const int play_row, const int play_col, std::promise<double> *result);
-	std::vector<std::tuple<int, int>> valid_moves(const piece p);
-	int score_board(const piece p);
-	void execute_move(const int row, const int col, const piece p, const bool display, windows_console& console);
-	void execute_move(const int row, const int col, const piece p);
-private:
-	std::vector<std::vector<piece>> _othelloboard_piece;
-	// helper function prototypes
-	void draw_line(windows_console& console, const char left, const char middle, const char right) const;
-	void draw_first_line(windows_console& console) const;
-	void draw_middle_line(windows_console& console) const;
-	void draw_last_line(windows_console& console) const;
-};
-
 //----------------------------------------------------------------------------
 // Display management
 
@@ -162,9 +96,10 @@ public:
 	INPUT_RECORD _inputRecord;
 	DWORD _events;
 	CONSOLE_SCREEN_BUFFER_INFO _csbi;
-	// create a window of given width x height
+	std::unique_ptr<console_screen> _screen; // frame of the board, drawn off-screen by print()
+	// create a window of given width x height, with a frame of width x frame_height at the top
 	// set the cursor to invisible, and set the title for the window
-	windows_console(const short width, const short height) {
+	windows_console(const short width, const short height, const short frame_height) : _screen(create_console_screen(width, frame_height)) {
 		const SMALL_RECT rect = {0, 0, (short) (width - 1), (short) (height - 1)};
 		const COORD coord = {width, height};
 		_std_output = GetStdHandle(STD_OUTPUT_HANDLE);
@@ -195,30 +130,33 @@ public:
 	}
 };
 
-windows_console console_null(0, 0);
-
 const std::string MARGIN = "  ";
 
 // ASCII caracters:
 // http://www.theasciicode.com.ar/extended-ascii-code/box-drawings-single-vertical-line-character-ascii-code-179.html
 
-void othello_game::draw_line(windows_console& console, const char left, const char middle, const char right) const {
-	std::cout << MARGIN << (char) left;
+void draw_line(windows_console& console, const char left, const char middle, const char right) {
+	console_screen& screen = *console._screen;
+	screen.put(MARGIN);
+	screen.put(left);
 	for(int i = 0; i < BOARD_SIZE - 1; i++) {
-		std::cout << std::string(7, (char) 196) << (char) middle;
+		screen.put(std::string(7, (char) 196));
+		screen.put(middle);
 	}
-	std::cout << std::string(7, (char) 196) << (char) right << std::endl;
+	screen.put(std::string(7, (char) 196));
+	screen.put(right);
+	screen.new_line();
 }
 
-void othello_game::draw_first_line(windows_console& console) const {
+void draw_first_line(windows_console& console) {
 	draw_line(console, (char) 218, (char) 194, (char) 191);
 }
 
-void othello_game::draw_middle_line(windows_console& console) const {
+void draw_middle_line(windows_console& console) {
 	draw_line(console, (char) 195, (char) 197, (char) 180);
 }
 
-void othello_game::draw_last_line(windows_console& console) const {
+void draw_last_line(windows_console& console) {
 	draw_line(console, (char) 192, (char) 193, (char) 217);
 }
 
@@ -257,52 +195,67 @@ const unsigned int COL_BACK = color_dark_green;
 const unsigned int COL_X_BACK = color_black;
 const unsigned int COL_O_BACK = color_white;
 
-void othello_game::print(windows_console& console, const int row, const int col, const bool player_turn, const double score) {
+char piece_display(const piece p) {
+	// return the display at the center of a square of p
+	switch (p) {
+		case piece::X:
+			return DISPLAY_X;
+		case piece::O:
+			return DISPLAY_O;
+		default:
+			return DISPLAY_E;
+		}
+}
+
+void print(windows_console& console, const othello_game& othello, const int row, const int col, const bool player_turn, const double score) {
 	// print the board on the screen
-	console.cursor({0,0});
-	console.color(COL_GRID, COL_BACK);
-	std::cout << std::endl;
+	// the frame is drawn off-screen, and only the squares changed since the last print are sent to the console
+	console_screen& screen = *console._screen;
+	screen.clear(COL_TEXT, COL_BACK);
+	screen.color(COL_GRID, COL_BACK);
+	screen.new_line();
 	draw_first_line(console);
 	for(int i = 0; i < BOARD_SIZE; i++) {
 		for(int k = 0; k < 3; k++) {
-			std::cout << MARGIN <<(char) 179;
+			screen.put(MARGIN);
+			screen.put((char) 179);
 			for(int j = 0; j < BOARD_SIZE; j++) {
 				if (i == row and j == col) {
-					if (get_othelloboard_piece(i, j) == piece::X) {
-						console.color(COL_SEL, COL_X_BACK);
-					} else if (get_othelloboard_piece(i, j) == piece::O) {
-						console.color(COL_SEL, COL_O_BACK);
+					if (othello.get_othelloboard_piece(i, j) == piece::X) {
+						screen.color(COL_SEL, COL_X_BACK);
+					} else if (othello.get_othelloboard_piece(i, j) == piece::O) {
+						screen.color(COL_SEL, COL_O_BACK);
 					} else {
-						console.color(COL_SEL, COL_BACK);
+						screen.color(COL_SEL, COL_BACK);
 					}
 				} else {
-					if (get_othelloboard_piece(i, j) == piece::X) {
-						console.color(COL_X, COL_X_BACK);
-					} else if (get_othelloboard_piece(i, j) == piece::O) {
-						console.color(COL_O, COL_O_BACK);
+					if (othello.get_othelloboard_piece(i, j) == piece::X) {
+						screen.color(COL_X, COL_X_BACK);
+					} else if (othello.get_othelloboard_piece(i, j) == piece::O) {
+						screen.color(COL_O, COL_O_BACK);
 					} else {
-						console.color(COL_GRID, COL_BACK);
+						screen.color(COL_GRID, COL_BACK);
 					}
 				}
-				std::cout << "   ";
+				screen.put("   ");
 				if (k == 1) {
 					if (i == row and j == col) {
 						if (MODE_PLAY == 'K' or MODE_PLAY == 'B') {
-							std::cout << DISPLAY_S;
+							screen.put(DISPLAY_S);
 						} else {
-							std::cout << ' ';
+							screen.put(' ');
 						}
 					} else {
-						std::cout << ((k == 1) ? get_othelloboard_piece_display(i, j) : ' ');
+						screen.put(piece_display(othello.get_othelloboard_piece(i, j)));
 					}
 				} else {
-					std::cout << DISPLAY_E;
+					screen.put(DISPLAY_E);
 				}
-				std::cout << "   ";
-				console.color(COL_GRID, COL_BACK);
-				std::cout << (char) 179;
+				screen.put("   ");
+				screen.color(COL_GRID, COL_BACK);
+				screen.put((char) 179);
 			}
-			std::cout << std::endl;
+			screen.new_line();
 		}
 		if (i == BOARD_SIZE - 1) {
 			draw_last_line(console);
@@ -310,251 +263,77 @@ void othello_game::print(windows_console& console, const int row, const int col,
 			draw_middle_line(console);
 		}
 	}
-	console.color(COL_TEXT, COL_BACK);
-	std::cout << MARGIN << "Player";
+	screen.color(COL_TEXT, COL_BACK);
+	screen.put(MARGIN + "Player");
 	const int size_comment = BOARD_SIZE * 8 - 13;
 	if (player_turn) {
 		if (size_comment > 8) {
-			std::cout << std::string(size_comment / 2 -  3, ' ');
-			std::cout << " [u]ndo ";
-			std::cout << std::string(size_comment - size_comment / 2 - 5, ' ');
+			screen.put(std::string(size_comment / 2 -  3, ' '));
+			screen.put(" [u]ndo ");
+			screen.put(std::string(size_comment - size_comment / 2 - 5, ' '));
 		} else {
-			std::cout << std::string(size_comment, ' ');
+			screen.put(std::string(size_comment, ' '));
 		}
 	} else {
-		std::cout << std::string(size_comment, ' ');
+		screen.put(std::string(size_comment, ' '));
 	}
-	std::cout << "Computer" << std::endl;
-	std::cout << MARGIN;
+	screen.put("Computer");
+	screen.new_line();
+	screen.put(MARGIN);
 	if (PLAYER == piece::X) {
-		console.color(COL_X, COL_X_BACK);
-		std::cout << ' ' << DISPLAY_X << ' ';
+		screen.color(COL_X, COL_X_BACK);
+		screen.put(std::string(" ") + DISPLAY_X + ' ');
 	} else {
-		console.color(COL_O, COL_O_BACK);
-		std::cout << ' ' << DISPLAY_O << ' ';
+		screen.color(COL_O, COL_O_BACK);
+		screen.put(std::string(" ") + DISPLAY_O + ' ');
 	}
-	console.color(COL_TEXT, COL_BACK);
-	std::cout << std::setfill(' ') << std::setw(3) << score_board(PLAYER);
-	std::cout << std::string(BOARD_SIZE * 8 - 13, ' ');
+	screen.color(COL_TEXT, COL_BACK);
+	std::ostringstream scores;
+	scores << std::setfill(' ') << std::setw(3) << othello.score_board(PLAYER);
+	scores << std::string(BOARD_SIZE * 8 - 13, ' ');
+	screen.put(scores.str());
 	if (COMPUTER == piece::X) {
-		console.color(COL_X, COL_X_BACK);
-		std::cout << ' ' << DISPLAY_X << ' ';
+		screen.color(COL_X, COL_X_BACK);
+		screen.put(std::string(" ") + DISPLAY_X + ' ');
 	} else {
-		console.color(COL_O, COL_O_BACK);
-		std::cout << ' ' << DISPLAY_O << ' ';
+		screen.color(COL_O, COL_O_BACK);
+		screen.put(std::string(" ") + DISPLAY_O + ' ');
 	}
-	console.color(COL_TEXT, COL_BACK);
-	std::cout << std::setfill(' ') << std::setw(5) << score_board(COMPUTER) << std::endl;
+	screen.color(COL_TEXT, COL_BACK);
+	std::ostringstream score_computer;
+	score_computer << std::setfill(' ') << std::setw(5) << othello.score_board(COMPUTER);
+	screen.put(score_computer.str());
+	screen.new_line();
 	if (player_turn) {
-		std::cout << MARGIN << "<play>" << std::string(BOARD_SIZE * 8 - 13, ' ');
+		screen.put(MARGIN + "<play>" + std::string(BOARD_SIZE * 8 - 13, ' '));
 		if (score >= 0. and DISPLAY_COMPUTER_SCORE) {
-			std::cout << "   " << std::setw(4) << std::right << (int) (1000. * score) / 10. << "%" << std::endl;
-		} else {
-			std::cout << "        " << std::endl;
+			std::ostringstream percent;
+			percent << "   " << std::setw(4) << std::right << (int) (1000. * score) / 10. << "%";
+			screen.put(percent.str());
 		}
 	} else {
-		std::cout << MARGIN << "      " << std::string(BOARD_SIZE * 8 - 13, ' ') << "  <play>" << std::endl;
+		screen.put(MARGIN + "      " + std::string(BOARD_SIZE * 8 - 13, ' ') + "  <play>");
 	}
+	screen.new_line();
+	screen.present();
 }
 
 //----------------------------------------------------------------------------
 
-const std::vector<std::tuple<int, int>> deltas = {{0,-1}, {1,-1}, {1,0}, {1,1}, {0,1}, {-1,1}, {-1,0}, {-1,-1}};
-
-std::vector<std::tuple<int, int>> othello_game::valid_moves(const piece p) {
-	// return the vector of all valid moves for p
-	std::vector<std::tuple<int, int>> moves;
-	for (int i = 0; i < BOARD_SIZE; i++) {
-		for (int j = 0; j < BOARD_SIZE; j++) {
-			// check if (i,j) is a valid move
-			bool valid = false;
-			if (get_othelloboard_piece(i, j) == piece::EMPTY) {
-				for (std::tuple<int, int> delta : deltas) {
-					const int di = std::get<0>(delta);
-					const int dj = std::get<1>(delta);
-					for (int k = 1; k < BOARD_SIZE; k++) {
-						const int new_i = i + k * di;
-						const int new_j = j + k * dj;
-						if (new_i >= 0 and new_i < BOARD_SIZE and new_j >= 0 and new_j < BOARD_SIZE) {
-							if (k == 1) {
-								if (get_othelloboard_piece(new_i, new_j) == piece::EMPTY or get_othelloboard_piece(new_i, new_j) == p) {
-									break;
-								}
-							} else if (get_othelloboard_piece(new_i, new_j) == piece::EMPTY) {
-								break;
-							} else if (get_othelloboard_piece(new_i, new_j) == p) {
-								valid = true;
-								break;
-							}
-						} else {
-							break;
-						}
-					}
-					if (valid) {break;}
-				}
-			}
-			if (valid) {
-				moves.push_back({i, j});
-			}
-		}
-	}
-	return moves;
-}
-
-void othello_game::execute_move(const int row, const int col, const piece p, const bool display, windows_console& console) {
-	// execute move (row,col) for p, with display of the effect
-	// it is assumed to be a valid move
-	for (std::tuple<int, int> delta : deltas) {
-		const int drow = std::get<0>(delta);
-		const int dcol = std::get<1>(delta);
-		for (int k = 1; k < BOARD_SIZE; k++) {
-			const int new_row = row + k * drow;
-			const int new_col = col + k * dcol;
-			if (new_row >= 0 and new_row < BOARD_SIZE and new_col >= 0 and new_col < BOARD_SIZE) {
-				if (k == 1) {
-					if (get_othelloboard_piece(new_row, new_col) == piece::EMPTY or get_othelloboard_piece(new_row, new_col) == p) {
-						break;
-					}
-				} else if (get_othelloboard_piece(new_row, new_col) == piece::EMPTY) {
-					break;
-				} else if (get_othelloboard_piece(new_row, new_col) == p) {
-					for (int k1 = 1; k1 < k; k1++) {
-						const int new_row = row + k1 * drow;
-						const int new_col = col + k1 * dcol;
-						set_othelloboard_piece(new_row, new_col, p);
-						if (display) {
-							Sleep(100);
-							print(console, -1, -1, true, 0);
-						}
-					}
-					break;
-				}
-			} else {
-				break;
-			}
-		}
-	}
-}
-
-void othello_game::execute_move(const int row, const int col, const piece p) {
-	// execute move (row,col) for p, without display of the effect
-	// it is assumed to be a valid move
-	execute_move(row, col, p, false, console_null);
-}
-
-int othello_game::score_board(const piece p) {
-	// return the number of pieces p on the board
-	int total = 0;
-	for (int i = 0; i < BOARD_SIZE; i++) {
-		for (int j = 0; j < BOARD_SIZE; j++) {
-			if (get_othelloboard_piece(i, j) == p) {
-				total++;
-			}
-		}
-	}
-	return total;
-}
-
-inline int computer_win(const int score_player, const int score_computer) {
-	// return 1 if computer wins; -1 if player wins; 0 if tie
-	if (score_player < score_computer) {
-		return 1;
-	} else if (score_player > score_computer) {
-		return -1;
-	} else {
-		return 0;
-	}
-}
-
-void othello_game::score_move(const int rand_seed, const int play_row, const int play_col, std::promise<double> *result) {
-	// return the score assessed
-	// computer has just played (play_row, play_col), so it is player's turn
-	srand(rand_seed);
-	int count_win = 0;
-	othello_game *othello_copy1 = new othello_game(*this);
-	othello_copy1->make_move(play_row, play_col, COMPUTER);
-	for (int i = 0; i < NUMBER_MONTE_CARLO_PATH; i++) {
-		othello_game *othello_copy2 = new othello_game(*othello_copy1);
-		int turn = 1;
-		int row;
-		int col;
-		bool game_blocked = false;
-		while (true) {
-			piece p;
-			if (turn % 2 == 1) {
-				// player's turn
-				p = PLAYER;
-			} else {
-				// computer's turn
-				p = COMPUTER;
-			}
-			std::vector<std::tuple<int, int>> possible_play = othello_copy2->valid_moves(p);
-			if (possible_play.size() == 0) {
-				// no possible move; pass
-				if (game_blocked) {
-					// no possible move twice; exit
-					break;
-				}
-				game_blocked = true;
-			} else {
-				// play one possible move randomly
-				const int rand_choice = random_range(0, possible_play.size() - 1);
-				row = std::get<0>(possible_play[rand_choice]);
-				col = std::get<1>(possible_play[rand_choice]);
-				othello_copy2->make_move(row, col, p);
-				game_blocked = false;
-			}
-			turn++;
-		}
-		const int score_player = othello_copy2->score_board(PLAYER);
-		const int score_computer = othello_copy2->score_board(COMPUTER);
-		if (computer_win(score_player, score_computer) == 1) {
-			count_win++;
-		}
-		delete othello_copy2;
-	}
-	delete othello_copy1;
-	result->set_value(1. * count_win / NUMBER_MONTE_CARLO_PATH);
-}
-
-double assess_move(othello_game& othello, windows_console& console, const int play_row, const int play_col) {
-	// definition of promise/future variables
-	std::promise<double> res_before[NUMBER_PROCESSOR];
-	std::future<double> res_after[NUMBER_PROCESSOR];
-	for (int i = 0; i < NUMBER_PROCESSOR; i++) {
-		res_after[i] = res_before[i].get_future();
-	}
-	std::thread monte_carlo_thread[NUMBER_PROCESSOR];
-	// definition of threads
-	for (int i = 0; i < NUMBER_PROCESSOR; i++) {
-		// it is critical to have different seeds for each thread
-		const int rand_seed = (1. + i / 10.) * time(0);
-		monte_carlo_thread[i] = std::thread(&othello_game::score_move, othello, rand_seed, play_row, play_col, &res_before[i]);
-	}
-	for (int i = 0; i < NUMBER_PROCESSOR; i++) {
-		monte_carlo_thread[i].join();
-	}
-	std::vector<double> out;
-	for (int i = 0; i < NUMBER_PROCESSOR; i++) {
-		out.push_back(res_after[i].get());
-	}
-	// averaging of results
-	const double average = std::accumulate(out.begin(), out.end(), 0.) / NUMBER_PROCESSOR;
-	return average;
-}
-
-double play_player_turn(windows_console& console, othello_game &othello, int &play_row, int &play_col, const double score, std::vector<othello_game> &othello_history) {
-	// Player's turn
-	std::vector<std::tuple<int, int>> player_moves = othello.valid_moves(PLAYER);
-	bool play_possible = (player_moves.size() > 0);
-	bool first_undo = true;
-	if (not play_possible) {return true;}
+void play_player_turn(windows_console& console, game_record &record, int &play_row, int &play_col, const double score) {
+	// Player's turn: the player plays a move, or moves in the game (undo, redo, load), which may give the turn to the computer
+	std::vector<std::tuple<int, int>> player_moves = record.get_game().valid_moves(PLAYER);
+	// the computer searches on the player's time until the player's move
+	PONDER.start(record.get_game(), PLAYER);
 	SetConsoleMode(console._std_input, ENABLE_PROCESSED_INPUT | ENABLE_MOUSE_INPUT);
 	while (true) {
-		othello.print(console, play_row, play_col, true, score);
+		print(console, record.get_game(), play_row, play_col, true, score);
 		std::tuple<int, int> move = {play_row, play_col};
 		bool move_done = false;
 		bool undo = false;
+		bool redo = false;
+		bool save = false;
+		bool load = false;
 		// necessary, though it was already done in windows_console()
 		ReadConsoleInput(console._std_input, &console._inputRecord, 1, &console._events);
 		const bool shift = GetKeyState(VK_SHIFT) & 0x8000;
@@ -599,6 +378,15 @@ double play_player_turn(windows_console& console, othello_game &othello, int &pl
 						case 0x55: // U (letter)
 							undo = true;
 							break;
+						case 0x52: // R (letter)
+							redo = true;
+							break;
+						case 0x53: // S (letter)
+							save = true;
+							break;
+						case 0x4C: // L (letter)
+							load = true;
+							break;
 						case VK_RETURN: // Enter
 						case VK_SPACE: // Space
 							if (MODE_PLAY == 'K' or MODE_PLAY == 'B') {
@@ -661,59 +449,73 @@ double play_player_turn(windows_console& console, othello_game &othello, int &pl
         }
         FlushConsoleInputBuffer(console._std_input);
 		if (undo) {
-			if (not othello_history.empty()) {
-				if (first_undo and othello_history.size() > 1) {
-					// the last element of othello_history is the current position
-					// hence we need to restore the preceding one for the 1st undo
-					othello_history.pop_back();
-					first_undo = false;
-				}
-				while (true) {
-					othello = othello_history.back();
-					if (othello_history.size() > 1) {
-						othello_history.pop_back();
-					}
-					player_moves = othello.valid_moves(PLAYER);
-					if (player_moves.size() > 0) {
-						break;
-					}
+			// back to the last position where the player was to move
+			int ply = record.get_ply() - 1;
+			while (ply >= 0 and record.get_move(ply)._player != PLAYER) {
+				ply--;
+			}
+			while (ply >= 0 and record.get_ply() > ply) {
+				record.undo();
+			}
+		}
+		if (redo) {
+			// forward to the next position where the player is to move, or to the last move undone
+			while (record.can_redo()) {
+				record.redo();
+				if (record.get_turn() == PLAYER) {
+					break;
 				}
 			}
 		}
+		if (save) {
+			std::ofstream file(GAME_FILE);
+			file << record.transcript() << std::endl;
+			if (not file) {
+				MessageBox(NULL, ("Cannot write the game to " + GAME_FILE).c_str(), "Othello by Arnaud", MB_OK);
+			}
+		}
+		if (load) {
+			std::ifstream file(GAME_FILE);
+			std::string text;
+			if (not std::getline(file, text) or not record.set_transcript(text)) {
+				MessageBox(NULL, ("Cannot read a game of this board size from " + GAME_FILE).c_str(), "Othello by Arnaud", MB_OK);
+			}
+		}
+		if (undo or redo or load) {
+			if (record.get_turn() != PLAYER) {
+				PONDER.stop();
+				print(console, record.get_game(), play_row, play_col, false, score);
+				return;
+			}
+			player_moves = record.get_game().valid_moves(PLAYER);
+			PONDER.start(record.get_game(), PLAYER);
+		}
 		if (move_done) {
 			break;
 		}
 	}
-	othello.make_move(console, play_row, play_col, PLAYER);
-	othello.print(console, play_row, play_col, true, score);
-	return false;
+	PONDER.stop();
+	// the move and its flipped pieces are drawn at once, as one frame
+	record.play(play_row, play_col);
+	print(console, record.get_game(), play_row, play_col, true, score);
 }
 
-double play_computer_turn(windows_console& console, othello_game &othello, int &play_row, int &play_col, double &score) {
+void play_computer_turn(windows_console& console, game_record &record, int &play_row, int &play_col, double &score) {
 	// Computer's turn
-	const std::vector<std::tuple<int, int>> computer_moves = othello.valid_moves(COMPUTER);
-	bool play_possible = (computer_moves.size() > 0);
-	if (not play_possible) {return true;}
-	int best_row = -1;
-	int best_col = -1;
-	double best_score = -0.;
-	for (std::tuple<int, int> move : computer_moves) {
-		const int row = std::get<0>(move);
-		const int col = std::get<1>(move);
-		othello.print(console, row, col, false, score);
-		const double s = assess_move(othello, console, row, col);
-		if (s > best_score or best_row == -1 or best_col == -1) {
-			best_score = s;
-			best_row = row;
-			best_col = col;
-		}
+	const othello_game& othello = record.get_game();
+	const search_clock::time_point start = search_clock::now();
+	// the red dot follows the analysis of the engine
+	const search_result result = search_move(othello, COMPUTER, computer_move_time(othello), [&console, &othello, score] (const int row, const int col) {
+		print(console, othello, row, col, false, score);
+	});
+	if (GAME_TIME > 0) {
+		GAME_TIME_LEFT -= std::chrono::duration_cast<std::chrono::milliseconds>(search_clock::now() - start).count();
 	}
-	play_row = best_row;
-	play_col = best_col;
-	score = best_score;
-	othello.make_move(console, play_row, play_col, COMPUTER);
-	othello.print(console, best_row, best_col, false, score);
-	return false;
+	play_row = result._row;
+	play_col = result._col;
+	score = result._score;
+	record.play(play_row, play_col);
+	print(console, othello, play_row, play_col, false, score);
 }
 
 void init_global_variables(int argc, char ** argv) {
@@ -721,24 +523,69 @@ void init_global_variables(int argc, char ** argv) {
 	if (argc >= 2) {BOARD_SIZE = (int) std::atoi(argv[1]);}
 	if (BOARD_SIZE < 4) {BOARD_SIZE = 4;}
 	if (BOARD_SIZE % 2 == 1) {BOARD_SIZE++;}
+	if (BOARD_SIZE > MAX_BOARD_SIZE) {BOARD_SIZE = MAX_BOARD_SIZE;}
 	if (argc >= 3) {const std::string str(argv[2]); PLAYER_START = (str != "NO");}
 	if (argc >= 4) {NUMBER_PROCESSOR = (int) std::atoi(argv[3]);}
 	if (NUMBER_PROCESSOR < 1) {NUMBER_PROCESSOR = 1;}
 	if (argc >= 5) {NUMBER_MONTE_CARLO_PATH = (int) std::atoi(argv[4]);}
 	if (NUMBER_MONTE_CARLO_PATH < 100) {NUMBER_MONTE_CARLO_PATH = 100;}
-	NUMBER_MONTE_CARLO_PATH = NUMBER_MONTE_CARLO_PATH / NUMBER_PROCESSOR;
 	if (argc >= 6) {const std::string str(argv[5]); DISPLAY_COMPUTER_SCORE = (str != "NO");}
 	if (argc >= 7) {const std::string str(argv[6]); MODE_PLAY = (char) str[0];}
 	if (MODE_PLAY != 'K' and MODE_PLAY != 'M') {MODE_PLAY = 'B';}
 	bool DISPLAY_MODIFS = true;
 	if (argc >= 8) {const std::string str(argv[7]); DISPLAY_MODIFS = (str != "NO");}
+	if (argc >= 9) {const std::string str(argv[8]); AI_MODE = (char) str[0];}
+	if (AI_MODE != 'T') {AI_MODE = 'F';}
+	if (argc >= 10) {MASTER_SEED = (uint64_t) std::strtoull(argv[9], nullptr, 10);}
+	if (argc >= 11) {MOVE_TIME = (int) std::atoi(argv[10]);}
+	if (MOVE_TIME < 0) {MOVE_TIME = 0;}
+	if (argc >= 12) {GAME_TIME = (int) std::atoi(argv[11]);}
+	if (GAME_TIME < 0) {GAME_TIME = 0;}
+	if (argc >= 13) {ENDGAME_EMPTY = (int) std::atoi(argv[12]);}
+	if (ENDGAME_EMPTY < 0) {ENDGAME_EMPTY = 0;}
+	if (argc >= 14) {HASH_SIZE = (int) std::atoi(argv[13]);}
+	if (HASH_SIZE < 0) {HASH_SIZE = 0;}
+	BOOK_FILE = (argc >= 15) ? argv[14] : "othello.book"; // ignored if missing (see init_engine())
+	if (BOOK_FILE == "-") {BOOK_FILE = "";}
+	if (argc >= 16) {ROLLOUT_DEPTH = (int) std::atoi(argv[15]);}
+	if (ROLLOUT_DEPTH < 0) {ROLLOUT_DEPTH = 0;}
+	EVAL_FILE = (argc >= 17) ? argv[16] : "othello.eval";
+	if (EVAL_FILE == "-") {EVAL_FILE = "";}
+	if (argc >= 18) {PONDER_CPU = (int) std::atoi(argv[17]);}
+	if (PONDER_CPU < 0) {PONDER_CPU = 0;}
+	if (PONDER_CPU > 100) {PONDER_CPU = 100;}
+	if (argc >= 19) {TELEMETRY_FILE = argv[18];}
+	if (TELEMETRY_FILE == "-") {TELEMETRY_FILE = "";}
+	if (argc >= 20) {GAME_FILE = argv[19];}
+	if (argc >= 21) {const std::string str(argv[20]); ROOT_PRUNING = (str != "NO");}
 	if (DISPLAY_MODIFS) {
 		std::cout << "Per command line, othello will use:" << std::endl << std::endl;
 		std::cout << "Board size             = " << BOARD_SIZE << std::endl;
 		std::cout << "Player starts          = " << ((PLAYER_START) ? "YES" : "NO")  << std::endl;
-		std::cout << "Monte Carlo paths      = " << NUMBER_MONTE_CARLO_PATH << " per processor" << std::endl;
+		std::cout << "Monte Carlo paths      = " << NUMBER_MONTE_CARLO_PATH << " per move" << std::endl;
 		std::cout << "Input mode (K,M,B)     = " << MODE_PLAY << std::endl;
 		std::cout << "Display computer score = " << ((DISPLAY_COMPUTER_SCORE) ? "YES" : "NO") << std::endl;
+		std::cout << "AI mode (F,T)          = " << AI_MODE << std::endl;
+		if (AI_MODE == 'F') {
+			std::cout << "Moves pruned           = " << ((ROOT_PRUNING) ? "YES" : "NO") << std::endl;
+		}
+		std::cout << "Random seed            = " << ((MASTER_SEED == 0) ? "from clock" : std::to_string(MASTER_SEED)) << std::endl;
+		if (MOVE_TIME > 0) {
+			std::cout << "Time per move          = " << MOVE_TIME << " ms" << std::endl;
+		} else if (GAME_TIME > 0) {
+			std::cout << "Time per game          = " << GAME_TIME << " s" << std::endl;
+		}
+		std::cout << "Endgame solved from    = " << ENDGAME_EMPTY << " empty squares" << std::endl;
+		std::cout << "Hash table size        = " << HASH_SIZE << " MB" << std::endl;
+		std::cout << "Opening book           = " << ((BOOK_FILE.empty()) ? "none" : BOOK_FILE) << std::endl;
+		if (ROLLOUT_DEPTH > 0 and not EVAL_FILE.empty()) {
+			std::cout << "Paths cut off after    = " << ROLLOUT_DEPTH << " moves (" << EVAL_FILE << ")" << std::endl;
+		}
+		std::cout << "Pondering              = " << ((PONDER_CPU > 0) ? std::to_string(PONDER_CPU) + " % of the CPU" : "none") << std::endl;
+		if (not TELEMETRY_FILE.empty()) {
+			std::cout << "Telemetry written to   = " << TELEMETRY_FILE << std::endl;
+		}
+		std::cout << "Game saved to (S, L)   = " << GAME_FILE << std::endl;
 		if (BOARD_SIZE >= 10) {
 			std::cout << std::endl << "Use the mouse to appropriately extend the window..."  << std::endl;
 		}
@@ -755,34 +602,32 @@ int main(int argc, char ** argv){
 	if (argc >= 2) {
 		init_global_variables(argc, argv);
 	}
-	windows_console console(BOARD_SIZE * 8 + 2 * MARGIN.length() + 1, BOARD_SIZE * 4 + 8);
+	init_engine();
+	thread_pool pool(NUMBER_PROCESSOR);
+	POOL = &pool;
+	windows_console console(BOARD_SIZE * 8 + 2 * MARGIN.length() + 1, BOARD_SIZE * 4 + 8, BOARD_SIZE * 4 + 5);
 	while (true) {
 		console.color(COL_TEXT, COL_BACK);
 		system("cls");
+		console._screen->invalidate();
 		PLAYER = (PLAYER_START) ? piece::X : piece::O;
 		COMPUTER = (PLAYER_START) ? piece::O : piece::X;
-		othello_game othello;
-		std::vector<othello_game> othello_history;
+		game_record record;
+		GAME_TIME_LEFT = 1000LL * GAME_TIME;
 		int play_row = BOARD_SIZE / 2 - 1;
 		int play_col = BOARD_SIZE / 2 - 1;
 		double score_move = 0.;
-		bool end1 = false;
-		bool end2 = false;
-		bool player_play = PLAYER_START;
-		while (not (end1 and end2)) {
-			// Player's turn
-			if (player_play) {
-				othello_history.push_back(othello);
-				end1 = play_player_turn(console, othello, play_row, play_col, score_move, othello_history);
+		// a player without a valid move passes, until the game is over
+		while (record.get_turn() != piece::EMPTY) {
+			if (record.get_turn() == PLAYER) {
+				play_player_turn(console, record, play_row, play_col, score_move);
 			} else {
-				player_play = true;
+				play_computer_turn(console, record, play_row, play_col, score_move);
 			}
-			// Computer's turn
-			end2 = play_computer_turn(console, othello, play_row, play_col, score_move);
 		}
 		console.color(COL_TEXT, COL_BACK);
-		const int score_player = othello.score_board(PLAYER);
-		const int score_computer = othello.score_board(COMPUTER);
+		const int score_player = record.get_game().score_board(PLAYER);
+		const int score_computer = record.get_game().score_board(COMPUTER);
 		const int winner = computer_win(score_player, score_computer);
 		std::cout << MARGIN << "Player has " << score_player << ". Computer has " << score_computer;
 		if (winner == -1) {
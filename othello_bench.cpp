@@ -0,0 +1,1298 @@
+/*
+	Othello benchmarks: speed of the engine on fixed positions, checks of the move
+	generators, and matches between two configurations of the engine, without any display
+
+	Compile options (any platform, no Windows specific code):
+	g++ -Wall -O3 -o othello_bench othello_bench.cpp othello_engine.cpp -std=c++11 -pthread
+
+	Debug (checks that the Monte Carlo paths make no heap allocation):
+	g++ -Wall -O1 -g -o othello_bench othello_bench.cpp othello_engine.cpp -std=c++11 -pthread -DOTHELLO_DEBUG
+
+	Telemetry counters (moves generated, pieces flipped, heap allocations) in the JSON lines of <telemetry_file>:
+	g++ -Wall -O3 -o othello_bench othello_bench.cpp othello_engine.cpp -std=c++11 -pthread -DOTHELLO_TELEMETRY
+*/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>    // setw(), setprecision()
+#include <string>
+#include <set>
+#include <algorithm>  // find()
+#include <cctype>     // isspace(), isdigit(), tolower()
+#include <cstdlib>    // atoi(), strtoull(), strtod()
+#include <cmath>      // log(), log10(), pow(), sqrt()
+#include <numeric>    // iota()
+#include "othello_engine.h"
+
+const char *USAGE =
+"syntax:\n"
+"othello_bench bench <board_size> <processors> <monte_carlo> <ai_mode> <move_time> <endgame> <hash_size> <seed> <rollout_depth> <eval_file> <telemetry_file>\n"
+"othello_bench perft <board_size> <depth> <processors> <rules_depth>\n"
+"othello_bench match <board_size> <processors> <games> <concurrency> <player_a> <player_b> <openings> <hash_size> <seed> <elo0> <elo1>\n"
+"othello_bench book <board_size> <processors> <book_file> <games> <book_depth> <player> <game_file> <seed>\n"
+"othello_bench train <board_size> <eval_file> <games> <epochs> <seed>\n"
+"othello_bench analyze <board_size> <processors> <positions> <player> <hash_size> <seed>\n"
+"\n"
+"bench: searches the moves of fixed positions (the start of the game, positions\n"
+"       of the middle game, and a position of the endgame), and reports the\n"
+"       random paths per second, the solver nodes per second and the time per move\n"
+"perft: counts the leaf nodes of the game tree from depth 1 to <depth>, from the\n"
+"       start of the game and from stored positions (a pass is one ply, a finished\n"
+"       game is a leaf), checks them against the reference counts, and reports\n"
+"       the nodes per second of the move generators, on 1 thread and in parallel,\n"
+"       and the plies per second of random games played with the rules of the game\n"
+"match: plays games between two configurations of the engine, <concurrency> games\n"
+"       at a time; each opening is played twice, with the colors swapped; the result,\n"
+"       the Elo difference of A over B and the SPRT of elo0 against elo1 are reported\n"
+"       after each game, and the match stops when the SPRT accepts one of them\n"
+"book:  builds an opening book from <games> games of self-play, <processors> games\n"
+"       at a time, or from the games of <game_file>: the moves of the first\n"
+"       <book_depth> plies are stored with their results (the games of an existing\n"
+"       <book_file> of the same board size are kept)\n"
+"train: fits the weights of the pattern evaluator to the final disc margins of\n"
+"       <games> random games (90% for the fit, 10% to check it), and writes them\n"
+"       to <eval_file>\n"
+"analyze: searches each position of <positions> with <player>, <processors>\n"
+"       positions at a time, and writes the best move, its score (or the exact\n"
+"       margin) and the time of each position as soon as it is searched; the\n"
+"       positions are read as they are needed, so that any number can be analyzed\n"
+"\n"
+"<board_size>   the size of the board                          (default = 8, even number from 4 to 16)\n"
+"<processors>   number of core processors to use               (default = 4)\n"
+"<monte_carlo>  Monte Carlo paths per move                     (default = 20000)\n"
+"<ai_mode>      F:flat Monte Carlo, T:Monte Carlo tree search  (default = F)\n"
+"<move_time>    time per move in milliseconds                  (default = 0, uses <monte_carlo> paths per move)\n"
+"<endgame>      number of empty squares solved exactly         (default = 14, 0 to never solve)\n"
+"<hash_size>    transposition table in MB                      (default = 64, 0 for no table)\n"
+"<seed>         seed of the random numbers, 0 from the clock   (default = 1, repeatable results)\n"
+"<rollout_depth> moves after which a random path is cut off and scored by the evaluator\n"
+"               (default = 0, paths played to the end)\n"
+"<eval_file>    weights of the evaluator                       (default = othello.eval)\n"
+"<telemetry_file> file to which a JSON line is appended per search (default = none)\n"
+"<depth>        depth of the perft                             (default = 7)\n"
+"<rules_depth>  depth of the perft also checked with the rules of the game (default = 5, slower)\n"
+"<games>        maximum number of games                        (default = 1000)\n"
+"<concurrency>  number of games played at the same time        (default = <processors>)\n"
+"<player_a>     configuration of the player A, as key=value separated by commas:\n"
+"<player_b>     paths (default = 20000), ai (F/T, default = F), time (ms per move, default = 0),\n"
+"               endgame (default = 14), threads (default = 1), book (file, default = none),\n"
+"               rollout (depth, default = 0), eval (file, default = none), prune (flat Monte Carlo:\n"
+"               1 to drop the moves clearly worse than the best one, 0 for the same paths for\n"
+"               all the moves, default = 1); e.g. paths=40000,ai=T\n"
+"<openings>     file of openings, one per line: a position, or moves from the start\n"
+"               (e.g. f5d6c3); - for all the positions after 4 moves (default = -)\n"
+"               match: <hash_size> defaults to 0, the table would be shared by all the games\n"
+"<elo0> <elo1>  Elo differences of the two hypotheses of the SPRT (default = 0 and 10)\n"
+"<book_file>    file of the opening book                       (default = othello.book)\n"
+"<book_depth>   number of plies of the games stored in the book (default = 20)\n"
+"<player>       configuration of the player of the self-play games, as <player_a>\n"
+"               (the first 4 plies of each game are random)\n"
+"<game_file>    file of games, one per line as moves from the start (e.g. f5d6c3...),\n"
+"               played to the end; - for self-play (default = -)\n"
+"<epochs>       number of passes over the positions of the games (default = 10)\n"
+"<positions>    file of positions, one per line: a position, or moves from the start\n"
+"               (e.g. f5d6c3); - for the standard input (default = -)\n"
+"               analyze: <hash_size> defaults to 0, the table would be shared by all the positions\n"
+"\n"
+"positions are written as one character per square (X, O or -), row by row,\n"
+"followed by the player to move; X plays first\n";
+
+const uint64_t BENCH_POSITION_SEED = 0xBE4C4; // seed of the random games giving the fixed positions
+int PERFT_DEPTH = 7; // perft: maximum depth
+int PERFT_RULES_DEPTH = 5; // perft: maximum depth checked with othello_game (slower than the bitboards)
+const int PERFT_RULES_GAMES = 1000; // perft: random games played with othello_game, to measure the cost of a ply
+int MATCH_GAMES = 1000; // match: maximum number of games
+int MATCH_CONCURRENCY = 0; // match: number of games played at the same time (0: NUMBER_PROCESSOR)
+std::string MATCH_PLAYER[2] = {"", ""}; // match: configurations of the players A and B
+std::string MATCH_OPENINGS = "-"; // match: file of openings ("-": all the positions after MATCH_OPENING_PLIES)
+double MATCH_ELO[2] = {0., 10.}; // match: Elo differences of the hypotheses H0 and H1 of the SPRT
+const int MATCH_OPENING_PLIES = 4;
+const double SPRT_ALPHA = 0.05; // probability of accepting H1 when H0 is true
+const double SPRT_BETA = 0.05; // probability of accepting H0 when H1 is true
+std::string BOOK_OUTPUT = "othello.book"; // book: file of the book built
+int BOOK_GAMES = 1000; // book: number of self-play games
+int BOOK_DEPTH = 20; // book: number of plies stored
+std::string BOOK_PLAYER = ""; // book: configuration of the self-play player
+std::string BOOK_GAMES_FILE = "-"; // book: file of games ("-": self-play)
+const int BOOK_RANDOM_PLIES = 4; // book: random plies at the start of a self-play game
+int TRAIN_GAMES = 20000; // train: number of random games
+int TRAIN_EPOCHS = 10; // train: number of passes over the positions
+const double TRAIN_RATE = 0.02; // train: step of the normalized least mean squares fit
+std::string ANALYZE_POSITIONS = "-"; // analyze: file of positions ("-": standard input)
+std::string ANALYZE_PLAYER = ""; // analyze: configuration of the player searching the positions
+
+struct perft_reference {
+	int _board_size;
+	const char *_position; // nullptr for the start of the game
+	std::vector<long long> _leaves; // number of leaf nodes at depth 1, 2, ...
+};
+
+// 8x8 start: OEIS A124004; the other counts were recorded with both move generators
+const std::vector<perft_reference> PERFT_REFERENCES = {
+	{4, nullptr, {4, 12, 44, 128, 424, 1256, 3624, 9116, 20044, 36540, 50704, 57436, 59564, 59980}},
+	{6, nullptr, {4, 12, 56, 244, 1364, 7604, 47740, 308716, 2114912, 14976792, 108820292}},
+	{6, "--OX-O--XX-O--XXOO-OOXO----OO-----OX X",
+		{8, 50, 387, 2298, 16967, 100016, 678136, 3843091, 23034840, 119006061}},
+	{8, nullptr, {4, 12, 56, 244, 1396, 8200, 55092, 390216, 3005288, 24571284, 212258800, 1939886636, 18429641748, 184042084512}},
+	{8, "----X-----XOX-XO---OOXOX--XOXOX----OOX-----OXXO----OOOX---O----- X",
+		{12, 177, 2113, 29631, 352583, 4735451, 56522434}},
+	{8, "OOOOOX--OOXOXX--OOOOX---XOOXXX--XOXXX---XXX--X--X-X------------- X", // X passes
+		{1, 14, 41, 538, 2391, 29942, 164212, 1981794}},
+	{8, "-OX-X-OXOOXOOOXX--XOOXXX-OXOOOXX-OXXXO-XOOXXOOOO---XXXOO-XXXXXOO X", // games finished from depth 9
+		{8, 50, 371, 2127, 13038, 62335, 297239, 1047229, 3471993, 7524700, 13235068, 13452790, 13559393, 13562985}},
+	{10, nullptr, {4, 12, 56, 244, 1396, 8200, 55180, 392268, 3045812, 25168320}},
+	{10, "----OX---X-----XXXX--OOO-XXO----OOOXXO-O--XOOOXOO---XOOOOOO----XOXOO------XOX-X----XO-OX----X-O-O--- X",
+		{17, 334, 5672, 108614, 1888372, 35724221}},
+	{12, nullptr, {4, 12, 56, 244, 1396, 8200, 55180, 392268, 3046196, 25179208}},
+	{12, "----X----X---X--OOO--XX---XXO-OOOOOO-OOXX-XXXX----OXOXOXOOO----OOOXOOO------OOOOO------OOXOOOXXX----OOXOOXX----OO--XXXO---O-----X-X------------X X",
+		{30, 668, 19713, 454951, 13257104, 314542027}},
+	{14, nullptr, {4, 12, 56, 244, 1396, 8200, 55180, 392268, 3046196, 25179208}},
+	{14, "O--------------OXX-X-O---O----OX--OO---OXX--OX-OOOOOOXO-O--XO--OOOXO-O-O-XOXXOOXXXX---XOOOOOXOOO---XOOOOOXXX-X-----XX-XXXXXXX----XXXOXOXO-----OX-XXXXXXXX-----XXX--XX--------X-----X---------------- X",
+		{27, 1041, 28845, 1143879, 32621127, 1318777030}},
+	{16, nullptr, {4, 12, 56, 244, 1396, 8200, 55180, 392268, 3046196, 25179208}},
+	{16, "-----------------O------X---O-X---OO--X-X---OX-O---OO-XOX-O-X-O---XXXXOXXOOOOO-O----XO-OXXXOOOO---XXXXXXXXXXOOOX-XXXXOXOXOXO--X---XXO-OXXOO-X--X---X-OXOOOXOX-X----XXXOOOOOXOX-----X-XOOXOOXXXX----X-O-XOOOXO-X----------OOOO-X-----------OO-O------------O----- X",
+		{37, 1587, 58364, 2533080, 93357560, 4101606981}},
+};
+
+void init_bench_variables(int argc, char ** argv) {
+	// re-initialize global variables from command line (argv[1] is the command)
+	MASTER_SEED = 1;
+	if (argc >= 3) {BOARD_SIZE = (int) std::atoi(argv[2]);}
+	if (BOARD_SIZE < 4) {BOARD_SIZE = 4;}
+	if (BOARD_SIZE % 2 == 1) {BOARD_SIZE++;}
+	if (BOARD_SIZE > MAX_BOARD_SIZE) {BOARD_SIZE = MAX_BOARD_SIZE;}
+	if (argc >= 4) {NUMBER_PROCESSOR = (int) std::atoi(argv[3]);}
+	if (NUMBER_PROCESSOR < 1) {NUMBER_PROCESSOR = 1;}
+	if (argc >= 5) {NUMBER_MONTE_CARLO_PATH = (int) std::atoi(argv[4]);}
+	if (NUMBER_MONTE_CARLO_PATH < 100) {NUMBER_MONTE_CARLO_PATH = 100;}
+	if (argc >= 6) {const std::string str(argv[5]); AI_MODE = (char) str[0];}
+	if (AI_MODE != 'T') {AI_MODE = 'F';}
+	if (argc >= 7) {MOVE_TIME = (int) std::atoi(argv[6]);}
+	if (MOVE_TIME < 0) {MOVE_TIME = 0;}
+	if (argc >= 8) {ENDGAME_EMPTY = (int) std::atoi(argv[7]);}
+	if (ENDGAME_EMPTY < 0) {ENDGAME_EMPTY = 0;}
+	if (argc >= 9) {HASH_SIZE = (int) std::atoi(argv[8]);}
+	if (HASH_SIZE < 0) {HASH_SIZE = 0;}
+	if (argc >= 10) {MASTER_SEED = (uint64_t) std::strtoull(argv[9], nullptr, 10);}
+	if (argc >= 11) {ROLLOUT_DEPTH = (int) std::atoi(argv[10]);}
+	if (ROLLOUT_DEPTH < 0) {ROLLOUT_DEPTH = 0;}
+	EVAL_FILE = (argc >= 12) ? argv[11] : "othello.eval";
+	if (argc >= 13) {TELEMETRY_FILE = argv[12];}
+}
+
+void init_perft_variables(int argc, char ** argv) {
+	// re-initialize global variables from command line (argv[1] is the command)
+	HASH_SIZE = 0;
+	if (argc >= 3) {BOARD_SIZE = (int) std::atoi(argv[2]);}
+	if (BOARD_SIZE < 4) {BOARD_SIZE = 4;}
+	if (BOARD_SIZE % 2 == 1) {BOARD_SIZE++;}
+	if (BOARD_SIZE > MAX_BOARD_SIZE) {BOARD_SIZE = MAX_BOARD_SIZE;}
+	if (argc >= 4) {PERFT_DEPTH = (int) std::atoi(argv[3]);}
+	if (PERFT_DEPTH < 1) {PERFT_DEPTH = 1;}
+	if (argc >= 5) {NUMBER_PROCESSOR = (int) std::atoi(argv[4]);}
+	if (NUMBER_PROCESSOR < 1) {NUMBER_PROCESSOR = 1;}
+	if (argc >= 6) {PERFT_RULES_DEPTH = (int) std::atoi(argv[5]);}
+	if (PERFT_RULES_DEPTH < 0) {PERFT_RULES_DEPTH = 0;}
+}
+
+void init_match_variables(int argc, char ** argv) {
+	// re-initialize global variables from command line (argv[1] is the command)
+	MASTER_SEED = 1;
+	HASH_SIZE = 0;
+	if (argc >= 3) {BOARD_SIZE = (int) std::atoi(argv[2]);}
+	if (BOARD_SIZE < 4) {BOARD_SIZE = 4;}
+	if (BOARD_SIZE % 2 == 1) {BOARD_SIZE++;}
+	if (BOARD_SIZE > MAX_BOARD_SIZE) {BOARD_SIZE = MAX_BOARD_SIZE;}
+	if (argc >= 4) {NUMBER_PROCESSOR = (int) std::atoi(argv[3]);}
+	if (NUMBER_PROCESSOR < 1) {NUMBER_PROCESSOR = 1;}
+	if (argc >= 5) {MATCH_GAMES = (int) std::atoi(argv[4]);}
+	if (MATCH_GAMES < 1) {MATCH_GAMES = 1;}
+	if (argc >= 6) {MATCH_CONCURRENCY = (int) std::atoi(argv[5]);}
+	if (MATCH_CONCURRENCY < 1) {MATCH_CONCURRENCY = NUMBER_PROCESSOR;}
+	if (argc >= 7) {MATCH_PLAYER[0] = argv[6];}
+	if (argc >= 8) {MATCH_PLAYER[1] = argv[7];}
+	if (argc >= 9) {MATCH_OPENINGS = argv[8];}
+	if (argc >= 10) {HASH_SIZE = (int) std::atoi(argv[9]);}
+	if (HASH_SIZE < 0) {HASH_SIZE = 0;}
+	if (argc >= 11) {MASTER_SEED = (uint64_t) std::strtoull(argv[10], nullptr, 10);}
+	if (argc >= 12) {MATCH_ELO[0] = std::strtod(argv[11], nullptr);}
+	if (argc >= 13) {MATCH_ELO[1] = std::strtod(argv[12], nullptr);}
+}
+
+void init_book_variables(int argc, char ** argv) {
+	// re-initialize global variables from command line (argv[1] is the command)
+	MASTER_SEED = 1;
+	HASH_SIZE = 0;
+	if (argc >= 3) {BOARD_SIZE = (int) std::atoi(argv[2]);}
+	if (BOARD_SIZE < 4) {BOARD_SIZE = 4;}
+	if (BOARD_SIZE % 2 == 1) {BOARD_SIZE++;}
+	if (BOARD_SIZE > MAX_BOARD_SIZE) {BOARD_SIZE = MAX_BOARD_SIZE;}
+	if (argc >= 4) {NUMBER_PROCESSOR = (int) std::atoi(argv[3]);}
+	if (NUMBER_PROCESSOR < 1) {NUMBER_PROCESSOR = 1;}
+	if (argc >= 5) {BOOK_OUTPUT = argv[4];}
+	if (argc >= 6) {BOOK_GAMES = (int) std::atoi(argv[5]);}
+	if (BOOK_GAMES < 1) {BOOK_GAMES = 1;}
+	if (argc >= 7) {BOOK_DEPTH = (int) std::atoi(argv[6]);}
+	if (BOOK_DEPTH < 1) {BOOK_DEPTH = 1;}
+	if (argc >= 8) {BOOK_PLAYER = argv[7];}
+	if (argc >= 9) {BOOK_GAMES_FILE = argv[8];}
+	if (argc >= 10) {MASTER_SEED = (uint64_t) std::strtoull(argv[9], nullptr, 10);}
+}
+
+void init_train_variables(int argc, char ** argv) {
+	// re-initialize global variables from command line (argv[1] is the command)
+	MASTER_SEED = 1;
+	HASH_SIZE = 0;
+	EVAL_FILE = "othello.eval";
+	if (argc >= 3) {BOARD_SIZE = (int) std::atoi(argv[2]);}
+	if (BOARD_SIZE < 4) {BOARD_SIZE = 4;}
+	if (BOARD_SIZE % 2 == 1) {BOARD_SIZE++;}
+	if (BOARD_SIZE > MAX_BOARD_SIZE) {BOARD_SIZE = MAX_BOARD_SIZE;}
+	if (argc >= 4) {EVAL_FILE = argv[3];}
+	if (argc >= 5) {TRAIN_GAMES = (int) std::atoi(argv[4]);}
+	if (TRAIN_GAMES < 10) {TRAIN_GAMES = 10;}
+	if (argc >= 6) {TRAIN_EPOCHS = (int) std::atoi(argv[5]);}
+	if (TRAIN_EPOCHS < 1) {TRAIN_EPOCHS = 1;}
+	if (argc >= 7) {MASTER_SEED = (uint64_t) std::strtoull(argv[6], nullptr, 10);}
+}
+
+void init_analyze_variables(int argc, char ** argv) {
+	// re-initialize global variables from command line (argv[1] is the command)
+	MASTER_SEED = 1;
+	HASH_SIZE = 0;
+	if (argc >= 3) {BOARD_SIZE = (int) std::atoi(argv[2]);}
+	if (BOARD_SIZE < 4) {BOARD_SIZE = 4;}
+	if (BOARD_SIZE % 2 == 1) {BOARD_SIZE++;}
+	if (BOARD_SIZE > MAX_BOARD_SIZE) {BOARD_SIZE = MAX_BOARD_SIZE;}
+	if (argc >= 4) {NUMBER_PROCESSOR = (int) std::atoi(argv[3]);}
+	if (NUMBER_PROCESSOR < 1) {NUMBER_PROCESSOR = 1;}
+	if (argc >= 5) {ANALYZE_POSITIONS = argv[4];}
+	if (argc >= 6) {ANALYZE_PLAYER = argv[5];}
+	if (argc >= 7) {HASH_SIZE = (int) std::atoi(argv[6]);}
+	if (HASH_SIZE < 0) {HASH_SIZE = 0;}
+	if (argc >= 8) {MASTER_SEED = (uint64_t) std::strtoull(argv[7], nullptr, 10);}
+}
+
+bool random_position(random_generator& rng, const int empty, othello_game &othello, piece &turn) {
+	// play a random game from the start until empty squares are left, with a valid move for turn
+	// return false if the game ends before
+	othello = othello_game();
+	turn = piece::X;
+	while (othello.score_board(piece::EMPTY) > empty) {
+		std::vector<std::tuple<int, int>> moves = othello.valid_moves(turn);
+		if (moves.empty()) {
+			turn = (turn == piece::X) ? piece::O : piece::X;
+			moves = othello.valid_moves(turn);
+			if (moves.empty()) {
+				return false;
+			}
+		}
+		const std::tuple<int, int> move = moves[rng.range(0, (int) moves.size() - 1)];
+		othello.make_move(std::get<0>(move), std::get<1>(move), turn);
+		turn = (turn == piece::X) ? piece::O : piece::X;
+	}
+	if (othello.valid_moves(turn).empty()) {
+		turn = (turn == piece::X) ? piece::O : piece::X;
+	}
+	return not othello.valid_moves(turn).empty();
+}
+
+std::vector<std::tuple<othello_game, piece>> bench_positions() {
+	// return the fixed positions of the benchmark: the start of the game, positions with 3/4, 1/2
+	// and 1/4 of the squares empty, and a position solved by the endgame solver (ENDGAME_EMPTY > 0)
+	std::vector<std::tuple<othello_game, piece>> positions;
+	positions.push_back(std::make_tuple(othello_game(), piece::X));
+	std::vector<int> empty = {3 * BOARD_SIZE * BOARD_SIZE / 4, BOARD_SIZE * BOARD_SIZE / 2, BOARD_SIZE * BOARD_SIZE / 4};
+	if (ENDGAME_EMPTY > 0) {
+		empty.push_back(std::min(ENDGAME_EMPTY, BOARD_SIZE * BOARD_SIZE - 5));
+	}
+	random_generator rng(BENCH_POSITION_SEED);
+	for (const int e : empty) {
+		othello_game othello;
+		piece turn;
+		while (not random_position(rng, e, othello, turn)) {}
+		positions.push_back(std::make_tuple(othello, turn));
+	}
+	return positions;
+}
+
+int run_bench() {
+	// search the fixed positions with the parameters, and report the speed of the engine
+	typedef std::chrono::duration<double, std::milli> milliseconds;
+	std::cout << "board size " << BOARD_SIZE << ", " << NUMBER_PROCESSOR << " threads, ai mode " << AI_MODE;
+	if (MOVE_TIME > 0) {
+		std::cout << ", " << MOVE_TIME << " ms per move";
+	} else {
+		std::cout << ", " << NUMBER_MONTE_CARLO_PATH << " paths per move";
+	}
+	std::cout << ", endgame " << ENDGAME_EMPTY << ", hash " << HASH_SIZE << " MB, seed " << MASTER_SEED << std::endl << std::endl;
+	std::cout << std::fixed;
+	// raw speed of the random paths, on the calling thread
+	{
+		const othello_game othello;
+		const std::tuple<int, int> move = othello.valid_moves(piece::X)[0];
+		// played one by one, then by batches when the processor allows it, then cut off (with an evaluator)
+		const bool simd_playouts = SIMD_PLAYOUTS;
+		const rollout_cutoff cutoff = search_parameters()._cutoff;
+		const rollout_cutoff no_cutoff = {nullptr, 0};
+		for (int mode = 0; mode < (cutoff.active() ? 3 : 2); mode++) {
+			SIMD_PLAYOUTS = (mode == 1);
+			RANDOM = new_random_stream();
+			const search_clock::time_point start = search_clock::now();
+			const int count_win = ENGINE->score_move(othello, std::get<0>(move), std::get<1>(move), piece::X, NUMBER_MONTE_CARLO_PATH, (mode == 2) ? cutoff : no_cutoff);
+			const double time = milliseconds(search_clock::now() - start).count();
+			std::cout << "random paths, 1 thread, ";
+			if (mode == 0) {
+				std::cout << "scalar: ";
+			} else if (mode == 1) {
+				std::cout << "batched (" << simd_playouts_name() << "): ";
+			} else {
+				std::cout << "cut off after " << cutoff._depth << " moves: ";
+			}
+			std::cout << std::setprecision(0) << 1000. * NUMBER_MONTE_CARLO_PATH / time << " paths/s, ";
+			std::cout << std::setprecision(2) << 100. * count_win / NUMBER_MONTE_CARLO_PATH << "% won" << std::endl;
+		}
+		SIMD_PLAYOUTS = simd_playouts;
+		std::cout << std::endl;
+	}
+	// searches
+	long long total_paths = 0;
+	long long total_nodes = 0;
+	double time_paths = 0.;
+	double time_nodes = 0.;
+	double time_total = 0.;
+	double time_max = 0.;
+	const std::vector<std::tuple<othello_game, piece>> positions = bench_positions();
+	for (size_t i = 0; i < positions.size(); i++) {
+		const othello_game& othello = std::get<0>(positions[i]);
+		const piece turn = std::get<1>(positions[i]);
+		TRANSPOSITION_TABLE.clear();
+		const search_clock::time_point start = search_clock::now();
+		const search_result result = search_move(othello, turn, MOVE_TIME);
+		const double time = milliseconds(search_clock::now() - start).count();
+		std::cout << "position " << i + 1 << ": " << othello.get_position(turn) << std::endl;
+		std::cout << "  empty " << othello.score_board(piece::EMPTY) << ", move " << move_name(result._row, result._col);
+		if (result._solved) {
+			std::cout << ", margin " << std::showpos << result._margin << std::noshowpos;
+		} else {
+			std::cout << ", score " << std::setprecision(1) << 100. * result._score << "%";
+		}
+		std::cout << ", " << std::setprecision(1) << time << " ms";
+		if (result._paths > 0) {
+			std::cout << ", " << result._paths << " paths (" << std::setprecision(0) << 1000. * result._paths / time << " paths/s)";
+			total_paths += result._paths;
+			time_paths += time;
+		}
+		if (result._nodes > 0) {
+			std::cout << ", " << result._nodes << " nodes (" << std::setprecision(0) << 1000. * result._nodes / time << " nodes/s)";
+			total_nodes += result._nodes;
+			time_nodes += time;
+		}
+		std::cout << std::endl;
+		time_total += time;
+		time_max = std::max(time_max, time);
+	}
+	std::cout << std::endl;
+	if (time_paths > 0.) {
+		std::cout << "random paths: " << std::setprecision(0) << 1000. * total_paths / time_paths << " paths/s" << std::endl;
+	}
+	if (time_nodes > 0.) {
+		std::cout << "endgame solver: " << std::setprecision(0) << 1000. * total_nodes / time_nodes << " nodes/s" << std::endl;
+	}
+	std::cout << "time per move: " << std::setprecision(1) << time_total / positions.size() << " ms average, " << time_max << " ms maximum" << std::endl;
+	return 0;
+}
+
+double rules_plies_per_second() {
+	// play PERFT_RULES_GAMES random games with the rules of othello_game (valid_moves() and make_move() on one board)
+	// and return the number of plies per second
+	typedef std::chrono::duration<double, std::milli> milliseconds;
+	random_generator rng(BENCH_POSITION_SEED);
+	long long plies = 0;
+	const search_clock::time_point start = search_clock::now();
+	for (int game = 0; game < PERFT_RULES_GAMES; game++) {
+		othello_game othello;
+		piece turn = piece::X;
+		bool game_blocked = false;
+		while (true) {
+			const std::vector<std::tuple<int, int>> moves = othello.valid_moves(turn);
+			if (moves.empty()) {
+				if (game_blocked) {
+					break;
+				}
+				game_blocked = true;
+			} else {
+				const std::tuple<int, int> move = moves[rng.range(0, (int) moves.size() - 1)];
+				othello.make_move(std::get<0>(move), std::get<1>(move), turn);
+				plies++;
+				game_blocked = false;
+			}
+			turn = (turn == piece::X) ? piece::O : piece::X;
+		}
+	}
+	const double time = milliseconds(search_clock::now() - start).count();
+	return (time > 0.) ? 1000. * plies / time : 0.;
+}
+
+int check_book_squares() {
+	// check the squares of the book: from the start and after each first move, the move stored for each valid move
+	// (book_square()) must give back a move of the same position (game_square()), and two moves share a stored move
+	// only if they lead to the same position (the same book key); return the number of errors
+	int errors = 0;
+	othello_game start;
+	std::vector<othello_game> positions(1, start);
+	for (const std::tuple<int, int>& move : start.valid_moves(piece::X)) {
+		positions.push_back(start);
+		positions.back().make_move(std::get<0>(move), std::get<1>(move), piece::X);
+	}
+	for (size_t i = 0; i < positions.size(); i++) {
+		const othello_game& othello = positions[i];
+		const piece turn = (i == 0) ? piece::X : piece::O;
+		const piece other = (i == 0) ? piece::O : piece::X;
+		int symmetries;
+		book_key(othello, turn, &symmetries);
+		const std::vector<std::tuple<int, int>> moves = othello.valid_moves(turn);
+		std::vector<uint64_t> keys; // book key after each move
+		for (const std::tuple<int, int>& move : moves) {
+			othello_game after = othello;
+			after.make_move(std::get<0>(move), std::get<1>(move), turn);
+			keys.push_back(book_key(after, other));
+		}
+		for (size_t m = 0; m < moves.size(); m++) {
+			const int square = std::get<0>(moves[m]) * BOARD_SIZE + std::get<1>(moves[m]);
+			const int stored = book_square(square, symmetries);
+			const int back = game_square(stored, symmetries);
+			const size_t found = std::find(moves.begin(), moves.end(), std::make_tuple(back / BOARD_SIZE, back % BOARD_SIZE)) - moves.begin();
+			bool ok = found < moves.size() and keys[found] == keys[m];
+			for (size_t n = 0; n < moves.size(); n++) {
+				const int other_square = std::get<0>(moves[n]) * BOARD_SIZE + std::get<1>(moves[n]);
+				ok = ok and ((book_square(other_square, symmetries) == stored) == (keys[n] == keys[m]));
+			}
+			if (not ok) {
+				std::cout << "book square of " << move_name(square / BOARD_SIZE, square % BOARD_SIZE) << " in " << othello.get_position(turn) << " FAILED" << std::endl;
+				errors++;
+			}
+		}
+	}
+	return errors;
+}
+
+int run_perft() {
+	// count the leaf nodes from the reference positions of BOARD_SIZE, and report the speed of the move generators
+	// return 1 if a count differs from its reference, or if the two move generators disagree
+	typedef std::chrono::duration<double, std::milli> milliseconds;
+	std::cout << "board size " << BOARD_SIZE << ", depth " << PERFT_DEPTH << ", " << NUMBER_PROCESSOR << " threads, rules depth " << PERFT_RULES_DEPTH << std::endl;
+	std::cout << std::fixed;
+	int errors = 0;
+	long long total_leaves = 0;
+	double time_single = 0.;
+	double time_parallel = 0.;
+	long long total_rules_leaves = 0;
+	double time_rules = 0.;
+	int number_position = 0;
+	for (const perft_reference& reference : PERFT_REFERENCES) {
+		if (reference._board_size != BOARD_SIZE) {
+			continue;
+		}
+		othello_game othello;
+		piece turn = piece::X;
+		if (reference._position != nullptr and not othello.set_position(reference._position, turn)) {
+			std::cout << "invalid position: " << reference._position << std::endl;
+			errors++;
+			continue;
+		}
+		number_position++;
+		std::cout << std::endl << "position " << number_position << ": " << othello.get_position(turn) << std::endl;
+		long long leaves = 0;
+		for (int depth = 1; depth <= PERFT_DEPTH; depth++) {
+			const search_clock::time_point start = search_clock::now();
+			leaves = ENGINE->perft(othello, turn, depth, false);
+			const double time = milliseconds(search_clock::now() - start).count();
+			std::cout << "  depth " << std::setw(2) << depth << ": " << std::setw(12) << leaves << " leaves, ";
+			if (depth <= (int) reference._leaves.size()) {
+				const bool ok = (leaves == reference._leaves[depth - 1]);
+				std::cout << (ok ? "reference ok" : "reference " + std::to_string(reference._leaves[depth - 1]) + " FAILED");
+				errors += ok ? 0 : 1;
+			} else {
+				std::cout << "no reference";
+			}
+			std::cout << ", " << std::setprecision(1) << time << " ms";
+			if (time > 0.) {
+				std::cout << " (" << std::setprecision(0) << 1000. * leaves / time << " nodes/s)";
+			}
+			if (depth <= PERFT_RULES_DEPTH) {
+				const search_clock::time_point rules_start = search_clock::now();
+				const long long game_leaves = game_perft(othello, turn, depth);
+				const double rules_time = milliseconds(search_clock::now() - rules_start).count();
+				std::cout << ((game_leaves == leaves) ? ", rules ok" : ", rules " + std::to_string(game_leaves) + " FAILED");
+				if (rules_time > 0.) {
+					std::cout << " (" << std::setprecision(0) << 1000. * game_leaves / rules_time << " nodes/s)";
+				}
+				errors += (game_leaves == leaves) ? 0 : 1;
+				if (depth == PERFT_RULES_DEPTH) {
+					time_rules += rules_time;
+					total_rules_leaves += game_leaves;
+				}
+			}
+			std::cout << std::endl;
+			if (depth == PERFT_DEPTH) {
+				time_single += time;
+			}
+		}
+		// parallel count at the maximum depth
+		const search_clock::time_point start = search_clock::now();
+		const long long parallel_leaves = ENGINE->perft(othello, turn, PERFT_DEPTH, true);
+		const double time = milliseconds(search_clock::now() - start).count();
+		std::cout << "  depth " << std::setw(2) << PERFT_DEPTH << " on " << NUMBER_PROCESSOR << " threads: " << parallel_leaves << " leaves";
+		std::cout << ((parallel_leaves == leaves) ? "" : " FAILED") << ", " << std::setprecision(1) << time << " ms";
+		if (time > 0.) {
+			std::cout << " (" << std::setprecision(0) << 1000. * parallel_leaves / time << " nodes/s)";
+		}
+		std::cout << std::endl;
+		errors += (parallel_leaves == leaves) ? 0 : 1;
+		total_leaves += leaves;
+		time_parallel += time;
+	}
+	std::cout << std::endl;
+	if (time_single > 0. and time_parallel > 0.) {
+		std::cout << "depth " << PERFT_DEPTH << ": " << std::setprecision(0) << 1000. * total_leaves / time_single << " nodes/s on 1 thread, ";
+		std::cout << 1000. * total_leaves / time_parallel << " nodes/s on " << NUMBER_PROCESSOR << " threads" << std::endl;
+	}
+	if (time_rules > 0.) {
+		std::cout << "depth " << PERFT_RULES_DEPTH << " with the rules of the game: " << std::setprecision(0) << 1000. * total_rules_leaves / time_rules << " nodes/s" << std::endl;
+	}
+	if (PERFT_RULES_DEPTH > 0) {
+		std::cout << "random games with the rules of the game: " << std::setprecision(0) << rules_plies_per_second() << " plies/s" << std::endl;
+	}
+	const int book_errors = check_book_squares();
+	std::cout << "book squares of the openings: " << ((book_errors == 0) ? "ok" : std::to_string(book_errors) + " FAILED") << std::endl;
+	errors += book_errors;
+	std::cout << ((errors == 0) ? "all counts ok" : std::to_string(errors) + " counts FAILED") << std::endl;
+	return (errors == 0) ? 0 : 1;
+}
+
+//----------------------------------------------------------------------------
+// Match
+
+struct match_player {
+	search_parameters _parameters;
+	int _move_time; // milliseconds per move (0: _number_path paths per move)
+	std::string _book_file; // opening book ("": none)
+	std::string _eval_file; // weights of the evaluator of the paths cut off ("": none)
+};
+
+struct match_statistics {
+	int _wins; // results of A
+	int _draws;
+	int _losses;
+	long long _moves[2]; // moves, search time in ms, random paths and solver nodes of A and B
+	double _time[2];
+	long long _paths[2];
+	long long _nodes[2];
+};
+
+bool parse_player(const std::string& configuration, match_player& player) {
+	// read the configuration of a player: key=value separated by commas (see USAGE)
+	// the keys not given take the default values of the command line, and 1 thread
+	player._parameters = search_parameters();
+	player._parameters._number_thread = 1;
+	player._parameters._book = nullptr;
+	player._parameters._cutoff._evaluator = nullptr;
+	player._parameters._cutoff._depth = 0;
+	player._move_time = 0;
+	player._book_file = "";
+	player._eval_file = "";
+	std::stringstream stream(configuration);
+	std::string item;
+	while (std::getline(stream, item, ',')) {
+		const size_t equal = item.find('=');
+		if (item.empty()) {
+			continue;
+		} else if (equal == std::string::npos) {
+			return false;
+		}
+		const std::string key = item.substr(0, equal);
+		const std::string value = item.substr(equal + 1);
+		if (key == "paths") {
+			player._parameters._number_path = std::max(100, std::atoi(value.c_str()));
+		} else if (key == "ai") {
+			player._parameters._ai_mode = (value == "T") ? 'T' : 'F';
+		} else if (key == "time") {
+			player._move_time = std::max(0, std::atoi(value.c_str()));
+		} else if (key == "endgame") {
+			player._parameters._endgame_empty = std::max(0, std::atoi(value.c_str()));
+		} else if (key == "threads") {
+			player._parameters._number_thread = std::max(1, std::atoi(value.c_str()));
+		} else if (key == "book") {
+			player._book_file = value;
+		} else if (key == "rollout") {
+			player._parameters._cutoff._depth = std::max(0, std::atoi(value.c_str()));
+		} else if (key == "eval") {
+			player._eval_file = value;
+		} else if (key == "prune") {
+			player._parameters._pruning = (value != "0");
+		} else {
+			return false;
+		}
+	}
+	return true;
+}
+
+std::string player_name(const match_player& player) {
+	// return the configuration of player, in the format of parse_player()
+	return "paths=" + std::to_string(player._parameters._number_path) + ",ai=" + std::string(1, player._parameters._ai_mode)
+		+ ",time=" + std::to_string(player._move_time) + ",endgame=" + std::to_string(player._parameters._endgame_empty)
+		+ ",threads=" + std::to_string(player._parameters._number_thread) + (player._book_file.empty() ? "" : ",book=" + player._book_file)
+		+ ((player._parameters._cutoff._depth == 0) ? "" : ",rollout=" + std::to_string(player._parameters._cutoff._depth))
+		+ (player._eval_file.empty() ? "" : ",eval=" + player._eval_file)
+		+ ((player._parameters._ai_mode == 'T') ? "" : ",prune=" + std::to_string(player._parameters._pruning ? 1 : 0));
+}
+
+bool open_player_files(match_player& player, opening_book& book, pattern_evaluator& evaluator) {
+	// open the book and the evaluator of player, if any; return false if one is not valid for BOARD_SIZE
+	if (not player._book_file.empty()) {
+		if (not book.open(player._book_file) or book.board_size() != BOARD_SIZE) {
+			std::cout << "invalid book for board size " << BOARD_SIZE << ": " << player._book_file << std::endl;
+			return false;
+		}
+		player._parameters._book = &book;
+	}
+	if (not player._eval_file.empty()) {
+		if (not evaluator.load(player._eval_file) or evaluator.board_size() != BOARD_SIZE) {
+			std::cout << "invalid evaluator for board size " << BOARD_SIZE << ": " << player._eval_file << std::endl;
+			return false;
+		}
+		player._parameters._cutoff._evaluator = &evaluator;
+	}
+	return true;
+}
+
+bool read_opening(const std::string& line, othello_game &othello, piece &turn) {
+	// read an opening: a position (see othello_game::get_position()), or moves from the start of the game (e.g. f5d6c3)
+	// a player without a valid move passes; the moves of a finished game are not an opening
+	if (othello.set_position(line, turn)) {
+		return true;
+	}
+	game_record record;
+	if (not record.set_transcript(line) or record.get_turn() == piece::EMPTY) {
+		return false;
+	}
+	othello = record.get_game();
+	turn = record.get_turn();
+	return true;
+}
+
+void add_openings(const othello_game& othello, const piece turn, const int plies, std::set<std::string>& seen, std::vector<std::tuple<othello_game, piece>>& openings) {
+	// add the distinct positions reached after plies moves to openings
+	const piece other = (turn == piece::X) ? piece::O : piece::X;
+	const std::vector<std::tuple<int, int>> moves = othello.valid_moves(turn);
+	if (plies == 0 or moves.empty()) {
+		if (not moves.empty() and seen.insert(othello.get_position(turn)).second) {
+			openings.push_back(std::make_tuple(othello, turn));
+		}
+		return;
+	}
+	for (std::tuple<int, int> move : moves) {
+		othello_game child = othello;
+		child.make_move(std::get<0>(move), std::get<1>(move), turn);
+		add_openings(child, other, plies - 1, seen, openings);
+	}
+}
+
+std::vector<std::tuple<othello_game, piece>> match_openings() {
+	// return the openings of the match, from MATCH_OPENINGS
+	std::vector<std::tuple<othello_game, piece>> openings;
+	if (MATCH_OPENINGS == "-") {
+		std::set<std::string> seen;
+		add_openings(othello_game(), piece::X, MATCH_OPENING_PLIES, seen, openings);
+		return openings;
+	}
+	std::ifstream file(MATCH_OPENINGS);
+	if (not file) {
+		std::cout << "cannot read " << MATCH_OPENINGS << std::endl;
+	}
+	std::string line;
+	while (std::getline(file, line)) {
+		if (not line.empty() and line.back() == '\r') {
+			line.pop_back();
+		}
+		if (line.empty() or line[0] == '#') {
+			continue;
+		}
+		othello_game othello;
+		piece turn;
+		if (read_opening(line, othello, turn)) {
+			openings.push_back(std::make_tuple(othello, turn));
+		} else {
+			std::cout << "invalid opening: " << line << std::endl;
+		}
+	}
+	return openings;
+}
+
+double play_match_game(othello_engine *engines[2], const match_player players[2], const int player_x, othello_game othello, piece turn, match_statistics& statistics, int discs[2]) {
+	// play a game from an opening, player_x (0 for A, 1 for B) playing X; return the score of A (1, 0.5 or 0)
+	// discs receives the final number of discs of A and B
+	typedef std::chrono::duration<double, std::milli> milliseconds;
+	bool game_blocked = false;
+	while (true) {
+		const int player = (turn == piece::X) ? player_x : 1 - player_x;
+		if (othello.valid_moves(turn).empty()) {
+			if (game_blocked) {
+				break;
+			}
+			game_blocked = true;
+		} else {
+			const search_clock::time_point start = search_clock::now();
+			const search_result result = search_move(*engines[player], players[player]._parameters, othello, turn, players[player]._move_time);
+			statistics._time[player] += milliseconds(search_clock::now() - start).count();
+			statistics._moves[player]++;
+			statistics._paths[player] += result._paths;
+			statistics._nodes[player] += result._nodes;
+			othello.make_move(result._row, result._col, turn);
+			game_blocked = false;
+		}
+		turn = (turn == piece::X) ? piece::O : piece::X;
+	}
+	discs[0] = othello.score_board((player_x == 0) ? piece::X : piece::O);
+	discs[1] = othello.score_board((player_x == 0) ? piece::O : piece::X);
+	return (discs[0] > discs[1]) ? 1. : ((discs[0] < discs[1]) ? 0. : 0.5);
+}
+
+double elo_difference(const double score) {
+	// return the Elo difference giving the expected score
+	return -400. * std::log10(1. / score - 1.);
+}
+
+void match_elo(const match_statistics& statistics, double &elo, double &margin, double &llr) {
+	// Elo difference of A over B, with its 95% confidence margin (normal approximation of the score
+	// of a game: win 1, draw 0.5, loss 0), and log-likelihood ratio of the SPRT, a draw counting as
+	// half a win and half a loss
+	const double n = statistics._wins + statistics._draws + statistics._losses;
+	const double score = (statistics._wins + 0.5 * statistics._draws) / n;
+	const double variance = (statistics._wins * std::pow(1. - score, 2) + statistics._draws * std::pow(0.5 - score, 2) + statistics._losses * std::pow(score, 2)) / n;
+	const double deviation = std::sqrt(variance / n);
+	const double low = std::max(1e-6, std::min(1. - 1e-6, score - 1.96 * deviation));
+	const double high = std::max(1e-6, std::min(1. - 1e-6, score + 1.96 * deviation));
+	elo = elo_difference(std::max(1e-6, std::min(1. - 1e-6, score)));
+	margin = (elo_difference(high) - elo_difference(low)) / 2.;
+	const double score0 = 1. / (1. + std::pow(10., -MATCH_ELO[0] / 400.));
+	const double score1 = 1. / (1. + std::pow(10., -MATCH_ELO[1] / 400.));
+	const double wins = statistics._wins + 0.5 * statistics._draws;
+	const double losses = statistics._losses + 0.5 * statistics._draws;
+	llr = wins * std::log(score1 / score0) + losses * std::log((1. - score1) / (1. - score0));
+}
+
+int run_match() {
+	// play the games of the match on MATCH_CONCURRENCY threads, the searches running on POOL
+	match_player players[2];
+	opening_book books[2];
+	pattern_evaluator evaluators[2];
+	for (int i = 0; i < 2; i++) {
+		if (not parse_player(MATCH_PLAYER[i], players[i])) {
+			std::cout << "invalid player: " << MATCH_PLAYER[i] << std::endl << std::endl << USAGE;
+			return 1;
+		}
+		if (not open_player_files(players[i], books[i], evaluators[i])) {
+			return 1;
+		}
+	}
+	const std::vector<std::tuple<othello_game, piece>> openings = match_openings();
+	if (openings.empty()) {
+		std::cout << "no opening" << std::endl;
+		return 1;
+	}
+	const double llr_lower = std::log(SPRT_BETA / (1. - SPRT_ALPHA));
+	const double llr_upper = std::log((1. - SPRT_BETA) / SPRT_ALPHA);
+	std::cout << "board size " << BOARD_SIZE << ", " << NUMBER_PROCESSOR << " threads, " << MATCH_GAMES << " games, " << MATCH_CONCURRENCY << " at a time, ";
+	std::cout << openings.size() << " openings, hash " << HASH_SIZE << " MB, seed " << MASTER_SEED << std::endl;
+	std::cout << "A: " << player_name(players[0]) << std::endl;
+	std::cout << "B: " << player_name(players[1]) << std::endl;
+	std::cout << "SPRT: H0 Elo = " << MATCH_ELO[0] << ", H1 Elo = " << MATCH_ELO[1] << ", alpha = " << SPRT_ALPHA << ", beta = " << SPRT_BETA << std::endl << std::endl;
+	std::cout << std::fixed;
+	match_statistics statistics = {0, 0, 0, {0, 0}, {0., 0.}, {0, 0}, {0, 0}};
+	double llr = 0.;
+	std::atomic<int> next_game(0);
+	std::atomic<bool> stop(false);
+	std::mutex match_mutex;
+	auto play_games = [&] {
+		// each thread has its own engines, the trees of a search being kept for the next one
+		std::unique_ptr<othello_engine> engine_a = create_engine(BOARD_SIZE);
+		std::unique_ptr<othello_engine> engine_b = create_engine(BOARD_SIZE);
+		othello_engine *engines[2] = {engine_a.get(), engine_b.get()};
+		while (not stop.load()) {
+			const int game = next_game++;
+			if (game >= MATCH_GAMES) {
+				break;
+			}
+			// each opening is played twice, A playing X first (like PLAYER_START, the colors alternate)
+			const int opening = (game / 2) % openings.size();
+			const int player_x = game % 2;
+			match_statistics game_statistics = {0, 0, 0, {0, 0}, {0., 0.}, {0, 0}, {0, 0}};
+			int discs[2];
+			const double score = play_match_game(engines, players, player_x, std::get<0>(openings[opening]), std::get<1>(openings[opening]), game_statistics, discs);
+			std::lock_guard<std::mutex> lock(match_mutex);
+			statistics._wins += (score == 1.) ? 1 : 0;
+			statistics._draws += (score == 0.5) ? 1 : 0;
+			statistics._losses += (score == 0.) ? 1 : 0;
+			for (int i = 0; i < 2; i++) {
+				statistics._moves[i] += game_statistics._moves[i];
+				statistics._time[i] += game_statistics._time[i];
+				statistics._paths[i] += game_statistics._paths[i];
+				statistics._nodes[i] += game_statistics._nodes[i];
+			}
+			double elo, margin;
+			match_elo(statistics, elo, margin, llr);
+			std::cout << "game " << game + 1 << " (opening " << opening + 1 << "): A (" << ((player_x == 0) ? 'X' : 'O') << ") " << discs[0] << " - " << discs[1] << " B";
+			std::cout << "; A +" << statistics._wins << " =" << statistics._draws << " -" << statistics._losses;
+			std::cout << ", Elo " << std::showpos << std::setprecision(1) << elo << std::noshowpos << " +/- " << margin;
+			std::cout << ", LLR " << std::setprecision(2) << llr << " (" << llr_lower << ", " << llr_upper << ")" << std::endl;
+			if (llr <= llr_lower or llr >= llr_upper) {
+				stop.store(true);
+			}
+		}
+	};
+	std::vector<std::thread> threads;
+	for (int i = 0; i < MATCH_CONCURRENCY; i++) {
+		threads.push_back(std::thread(play_games));
+	}
+	for (std::thread& t : threads) {
+		t.join();
+	}
+	std::cout << std::endl;
+	for (int i = 0; i < 2; i++) {
+		const double moves = std::max(1LL, statistics._moves[i]);
+		std::cout << ((i == 0) ? "A: " : "B: ") << std::setprecision(1) << statistics._time[i] / moves << " ms per move, ";
+		std::cout << std::setprecision(0) << statistics._paths[i] / moves << " paths per move, " << statistics._nodes[i] / moves << " solver nodes per move" << std::endl;
+	}
+	if (llr >= llr_upper) {
+		std::cout << "SPRT: H1 accepted, A is stronger than B by " << MATCH_ELO[1] << " Elo or more" << std::endl;
+	} else if (llr <= llr_lower) {
+		std::cout << "SPRT: H0 accepted, A is not stronger than B by more than " << MATCH_ELO[0] << " Elo" << std::endl;
+	} else {
+		std::cout << "SPRT: no decision" << std::endl;
+	}
+	return 0;
+}
+
+//----------------------------------------------------------------------------
+// Opening book
+
+bool add_book_game(const game_record& record, std::vector<book_entry>& entries) {
+	// add the first BOOK_DEPTH moves of a finished game to entries, with the result of the player of each move
+	// return false if the game is not over
+	if (record.get_turn() != piece::EMPTY) {
+		return false;
+	}
+	const int score_x = record.get_game().score_board(piece::X);
+	const int score_o = record.get_game().score_board(piece::O);
+	// the moves are replayed from the start of the game
+	game_record game = record;
+	while (game.can_undo()) {
+		game.undo();
+	}
+	for (int i = 0; i < record.get_ply() and i < BOOK_DEPTH; i++) {
+		const game_ply& move = record.get_move(i);
+		const int own = (move._player == piece::X) ? score_x : score_o;
+		const int other = (move._player == piece::X) ? score_o : score_x;
+		// the position is stored in its canonical orientation, with the move
+		int symmetries;
+		const uint64_t key = book_key(game.get_game(), move._player, &symmetries);
+		book_entry entry = {key, 1, (uint32_t) ((own > other) ? 2 : ((own == other) ? 1 : 0)), (uint16_t) book_square(move._row * BOARD_SIZE + move._col, symmetries), {0, 0, 0}};
+		entries.push_back(entry);
+		game.redo();
+	}
+	return true;
+}
+
+game_record play_book_game(othello_engine& engine, const match_player& player, random_generator& rng) {
+	// play a self-play game: BOOK_RANDOM_PLIES random moves, then the moves of the engine
+	game_record record;
+	while (record.get_turn() != piece::EMPTY) {
+		const std::vector<std::tuple<int, int>> valid_moves = record.get_game().valid_moves(record.get_turn());
+		std::tuple<int, int> move = valid_moves[rng.range(0, (int) valid_moves.size() - 1)];
+		if (record.get_ply() >= BOOK_RANDOM_PLIES) {
+			const search_result result = search_move(engine, player._parameters, record.get_game(), record.get_turn(), player._move_time);
+			move = std::make_tuple(result._row, result._col);
+		}
+		record.play(std::get<0>(move), std::get<1>(move));
+	}
+	return record;
+}
+
+int run_book() {
+	// build the opening book BOOK_OUTPUT from self-play games (NUMBER_PROCESSOR at a time) or from BOOK_GAMES_FILE
+	match_player player;
+	opening_book player_book;
+	pattern_evaluator player_evaluator;
+	if (not parse_player(BOOK_PLAYER, player)) {
+		std::cout << "invalid player: " << BOOK_PLAYER << std::endl << std::endl << USAGE;
+		return 1;
+	}
+	if (not open_player_files(player, player_book, player_evaluator)) {
+		return 1;
+	}
+	std::cout << "board size " << BOARD_SIZE << ", book " << BOOK_OUTPUT << ", depth " << BOOK_DEPTH << " plies, ";
+	if (BOOK_GAMES_FILE == "-") {
+		std::cout << BOOK_GAMES << " self-play games, " << NUMBER_PROCESSOR << " at a time, seed " << MASTER_SEED << std::endl;
+		std::cout << "player: " << player_name(player) << std::endl;
+	} else {
+		std::cout << "games of " << BOOK_GAMES_FILE << std::endl;
+	}
+	std::vector<book_entry> entries;
+	{
+		opening_book book;
+		if (book.open(BOOK_OUTPUT) and book.board_size() == BOARD_SIZE) {
+			entries.assign(book.begin(), book.end());
+			std::cout << "existing book: " << book.size() << " moves" << std::endl;
+		}
+	}
+	std::cout << std::endl;
+	int number_game = 0;
+	if (BOOK_GAMES_FILE != "-") {
+		std::ifstream file(BOOK_GAMES_FILE);
+		if (not file) {
+			std::cout << "cannot read " << BOOK_GAMES_FILE << std::endl;
+			return 1;
+		}
+		std::string line;
+		while (std::getline(file, line)) {
+			if (not line.empty() and line.back() == '\r') {
+				line.pop_back();
+			}
+			if (line.empty() or line[0] == '#') {
+				continue;
+			}
+			game_record record;
+			if (record.set_transcript(line) and add_book_game(record, entries)) {
+				number_game++;
+			} else {
+				std::cout << "invalid or unfinished game: " << line << std::endl;
+			}
+		}
+	} else {
+		std::atomic<int> next_game(0);
+		std::mutex book_mutex;
+		auto play_games = [&] {
+			std::unique_ptr<othello_engine> engine = create_engine(BOARD_SIZE);
+			while (true) {
+				const int game = next_game++;
+				if (game >= BOOK_GAMES) {
+					break;
+				}
+				random_generator rng = new_random_stream();
+				const game_record record = play_book_game(*engine, player, rng);
+				std::lock_guard<std::mutex> lock(book_mutex);
+				add_book_game(record, entries);
+				number_game++;
+				std::cout << "game " << game + 1 << ":";
+				for (int i = 0; i < record.get_ply() and i < BOOK_DEPTH; i++) {
+					std::cout << ((i == 0) ? " " : "") << move_name(record.get_move(i)._row, record.get_move(i)._col);
+				}
+				std::cout << std::endl;
+			}
+		};
+		std::vector<std::thread> threads;
+		for (int i = 0; i < NUMBER_PROCESSOR; i++) {
+			threads.push_back(std::thread(play_games));
+		}
+		for (std::thread& t : threads) {
+			t.join();
+		}
+	}
+	if (not opening_book::write(BOOK_OUTPUT, BOARD_SIZE, entries)) {
+		std::cout << "cannot write " << BOOK_OUTPUT << std::endl;
+		return 1;
+	}
+	// check the book, as the engine maps it
+	opening_book book;
+	if (not book.open(BOOK_OUTPUT)) {
+		std::cout << "invalid book written: " << BOOK_OUTPUT << std::endl;
+		return 1;
+	}
+	size_t positions = 0;
+	for (const book_entry *entry = book.begin(); entry != book.end(); entry++) {
+		positions += (entry == book.begin() or entry[-1]._key != entry->_key) ? 1 : 0;
+	}
+	std::cout << std::endl << number_game << " games added; " << BOOK_OUTPUT << ": " << positions << " positions, " << book.size() << " moves, ";
+	std::cout << sizeof(book_header) + book.size() * sizeof(book_entry) << " bytes" << std::endl;
+	double score = 0.;
+	int symmetries;
+	const uint64_t key = book_key(othello_game(), piece::X, &symmetries);
+	const int move = game_square(book.best_move(key, score), symmetries);
+	if (move >= 0) {
+		std::cout << "book move from the start: " << move_name(move / BOARD_SIZE, move % BOARD_SIZE) << ", score " << std::fixed << std::setprecision(1) << 100. * score << "%" << std::endl;
+	}
+	return 0;
+}
+
+//----------------------------------------------------------------------------
+// Evaluator training
+
+struct train_sample {
+	uint16_t _indexes[EVAL_MAX_INSTANCE]; // features of the position (see pattern_evaluator::features())
+	int16_t _mobility;
+	int16_t _empty;
+	int16_t _margin; // final disc margin of the player to move
+};
+
+void add_random_game(random_generator& rng, const pattern_evaluator& evaluator, std::vector<train_sample>& samples) {
+	// play a random game from the start, and add its positions (with a valid move for the player to move) to samples
+	othello_game othello;
+	piece turn = piece::X;
+	std::vector<piece> movers;
+	const size_t first = samples.size();
+	bool game_blocked = false;
+	while (true) {
+		const std::vector<std::tuple<int, int>> moves = othello.valid_moves(turn);
+		if (moves.empty()) {
+			if (game_blocked) {
+				break;
+			}
+			game_blocked = true;
+		} else {
+			int indexes[EVAL_MAX_INSTANCE];
+			int mobility;
+			int empty;
+			evaluator.features(othello, turn, indexes, mobility, empty);
+			train_sample sample;
+			std::copy(indexes, indexes + evaluator.number_instance(), sample._indexes);
+			sample._mobility = (int16_t) mobility;
+			sample._empty = (int16_t) empty;
+			sample._margin = 0;
+			samples.push_back(sample);
+			movers.push_back(turn);
+			const std::tuple<int, int> move = moves[rng.range(0, (int) moves.size() - 1)];
+			othello.make_move(std::get<0>(move), std::get<1>(move), turn);
+			game_blocked = false;
+		}
+		turn = (turn == piece::X) ? piece::O : piece::X;
+	}
+	const int margin_x = othello.score_board(piece::X) - othello.score_board(piece::O);
+	for (size_t i = first; i < samples.size(); i++) {
+		samples[i]._margin = (int16_t) ((movers[i - first] == piece::X) ? margin_x : -margin_x);
+	}
+}
+
+float sample_value(const pattern_evaluator& evaluator, const train_sample& sample) {
+	int indexes[EVAL_MAX_INSTANCE];
+	std::copy(sample._indexes, sample._indexes + evaluator.number_instance(), indexes);
+	return evaluator.value(indexes, sample._mobility, sample._empty);
+}
+
+void check_evaluator(const pattern_evaluator& evaluator, const std::vector<train_sample>& samples, const size_t first, const size_t last, double &error, double &agreement) {
+	// error: root mean square error of the evaluations of samples [first, last)
+	// agreement: fraction of the samples not drawn where the evaluation has the sign of the margin
+	double sum = 0.;
+	long long decided = 0;
+	long long agreed = 0;
+	for (size_t i = first; i < last; i++) {
+		const double e = samples[i]._margin - sample_value(evaluator, samples[i]);
+		sum += e * e;
+		if (samples[i]._margin != 0) {
+			decided++;
+			agreed += ((samples[i]._margin > 0) == (sample_value(evaluator, samples[i]) > 0.f)) ? 1 : 0;
+		}
+	}
+	error = std::sqrt(sum / std::max((size_t) 1, last - first));
+	agreement = (decided > 0) ? 1. * agreed / decided : 0.;
+}
+
+int run_train() {
+	// fit the evaluator by normalized least mean squares on the positions of random games, and write it to EVAL_FILE
+	pattern_evaluator evaluator;
+	evaluator.reset(BOARD_SIZE);
+	std::cout << "board size " << BOARD_SIZE << ", " << TRAIN_GAMES << " random games, " << TRAIN_EPOCHS << " epochs, seed " << MASTER_SEED << std::endl;
+	std::cout << std::fixed;
+	random_generator rng(MASTER_SEED);
+	std::vector<train_sample> samples;
+	size_t fit_size = 0;
+	for (int game = 0; game < TRAIN_GAMES; game++) {
+		if (game == TRAIN_GAMES - TRAIN_GAMES / 10) {
+			fit_size = samples.size();
+		}
+		add_random_game(rng, evaluator, samples);
+	}
+	std::cout << fit_size << " positions to fit, " << samples.size() - fit_size << " to check" << std::endl << std::endl;
+	double error, agreement;
+	check_evaluator(evaluator, samples, fit_size, samples.size(), error, agreement);
+	std::cout << "no weight: error " << std::setprecision(2) << error << " discs" << std::endl;
+	std::vector<size_t> order(fit_size);
+	std::iota(order.begin(), order.end(), 0);
+	for (int epoch = 1; epoch <= TRAIN_EPOCHS; epoch++) {
+		for (size_t i = fit_size; i > 1; i--) {
+			std::swap(order[i - 1], order[rng.range(0, (int) i - 1)]);
+		}
+		for (const size_t i : order) {
+			const train_sample& sample = samples[i];
+			const float step = (float) (TRAIN_RATE / epoch * (sample._margin - sample_value(evaluator, sample)) / (evaluator.number_instance() + 1 + sample._mobility * sample._mobility));
+			for (int k = 0; k < evaluator.number_instance(); k++) {
+				evaluator.weight(evaluator.instance_pattern(k), sample._indexes[k]) += step;
+			}
+			evaluator.mobility() += step * sample._mobility;
+			evaluator.bias(sample._empty) += step;
+		}
+		// the biases are then set exactly (the mean error at each number of empty squares is removed), with the deviations
+		std::vector<double> error_sum(BOARD_SIZE * BOARD_SIZE + 1, 0.);
+		std::vector<double> error_square(BOARD_SIZE * BOARD_SIZE + 1, 0.);
+		std::vector<long long> error_count(BOARD_SIZE * BOARD_SIZE + 1, 0);
+		for (size_t i = 0; i < fit_size; i++) {
+			const double e = samples[i]._margin - sample_value(evaluator, samples[i]);
+			error_sum[samples[i]._empty] += e;
+			error_square[samples[i]._empty] += e * e;
+			error_count[samples[i]._empty]++;
+		}
+		for (int empty = 0; empty <= BOARD_SIZE * BOARD_SIZE; empty++) {
+			const double n = (double) std::max(1LL, error_count[empty]);
+			const double mean = error_sum[empty] / n;
+			evaluator.bias(empty) += (float) mean;
+			evaluator.deviation(empty) = (float) std::max(1., std::sqrt(std::max(0., error_square[empty] / n - mean * mean)));
+		}
+		double fit_error, fit_agreement;
+		check_evaluator(evaluator, samples, 0, fit_size, fit_error, fit_agreement);
+		check_evaluator(evaluator, samples, fit_size, samples.size(), error, agreement);
+		std::cout << "epoch " << epoch << ": error " << std::setprecision(2) << fit_error << " discs (fit), " << error << " discs (check), ";
+		std::cout << std::setprecision(1) << 100. * agreement << "% of the winners predicted (check)" << std::endl;
+	}
+	if (not evaluator.save(EVAL_FILE)) {
+		std::cout << "cannot write " << EVAL_FILE << std::endl;
+		return 1;
+	}
+	std::cout << std::endl << "weights written to " << EVAL_FILE << std::endl;
+	return 0;
+}
+
+//----------------------------------------------------------------------------
+// Analysis
+
+int run_analyze() {
+	// search the positions of ANALYZE_POSITIONS on NUMBER_PROCESSOR threads, each thread reading the next line
+	// when its search is over: only the positions being searched are in memory
+	typedef std::chrono::duration<double, std::milli> milliseconds;
+	match_player player;
+	opening_book book;
+	pattern_evaluator evaluator;
+	if (not parse_player(ANALYZE_PLAYER, player)) {
+		std::cout << "invalid player: " << ANALYZE_PLAYER << std::endl << std::endl << USAGE;
+		return 1;
+	}
+	if (not open_player_files(player, book, evaluator)) {
+		return 1;
+	}
+	std::ifstream file;
+	if (ANALYZE_POSITIONS != "-") {
+		file.open(ANALYZE_POSITIONS);
+		if (not file) {
+			std::cout << "cannot read " << ANALYZE_POSITIONS << std::endl;
+			return 1;
+		}
+	}
+	std::istream& input = (ANALYZE_POSITIONS == "-") ? std::cin : file;
+	std::cout << "board size " << BOARD_SIZE << ", positions of " << ((ANALYZE_POSITIONS == "-") ? "the standard input" : ANALYZE_POSITIONS);
+	std::cout << ", " << NUMBER_PROCESSOR << " at a time, hash " << HASH_SIZE << " MB, seed " << MASTER_SEED << std::endl;
+	std::cout << "player: " << player_name(player) << std::endl << std::endl;
+	std::cout << std::fixed;
+	int number_line = 0;
+	int number_position = 0;
+	int number_invalid = 0;
+	long long total_paths = 0;
+	long long total_nodes = 0;
+	std::mutex analyze_mutex; // input, output and totals
+	const search_clock::time_point start = search_clock::now();
+	auto analyze_positions = [&] {
+		// each thread has its own engine
+		std::unique_ptr<othello_engine> engine = create_engine(BOARD_SIZE);
+		std::string line;
+		while (true) {
+			int number;
+			{
+				std::lock_guard<std::mutex> lock(analyze_mutex);
+				if (not std::getline(input, line)) {
+					break;
+				}
+				number = ++number_line;
+			}
+			if (not line.empty() and line.back() == '\r') {
+				line.pop_back();
+			}
+			if (line.empty() or line[0] == '#') {
+				continue;
+			}
+			othello_game othello;
+			piece turn;
+			if (not read_opening(line, othello, turn)) {
+				std::lock_guard<std::mutex> lock(analyze_mutex);
+				std::cout << "line " << number << ": invalid position: " << line << std::endl;
+				number_invalid++;
+				continue;
+			}
+			const search_clock::time_point position_start = search_clock::now();
+			const search_result result = search_move(*engine, player._parameters, othello, turn, player._move_time);
+			const double time = milliseconds(search_clock::now() - position_start).count();
+			std::lock_guard<std::mutex> lock(analyze_mutex);
+			std::cout << "line " << number << ": " << othello.get_position(turn) << ", move " << move_name(result._row, result._col);
+			if (result._solved) {
+				std::cout << ", margin " << std::showpos << result._margin << std::noshowpos;
+			} else if (result._row >= 0) {
+				std::cout << ", score " << std::setprecision(1) << 100. * result._score << "%";
+			}
+			std::cout << ", " << std::setprecision(1) << time << " ms, " << result._paths << " paths, " << result._nodes << " nodes" << std::endl;
+			number_position++;
+			total_paths += result._paths;
+			total_nodes += result._nodes;
+		}
+	};
+	std::vector<std::thread> threads;
+	for (int i = 0; i < NUMBER_PROCESSOR; i++) {
+		threads.push_back(std::thread(analyze_positions));
+	}
+	for (std::thread& t : threads) {
+		t.join();
+	}
+	const double time = milliseconds(search_clock::now() - start).count();
+	std::cout << std::endl << number_position << " positions analyzed, " << number_invalid << " invalid, " << std::setprecision(1) << time / 1000. << " s";
+	if (time > 0.) {
+		std::cout << " (" << std::setprecision(2) << 1000. * number_position / time << " positions/s, ";
+		std::cout << std::setprecision(0) << 1000. * total_paths / time << " paths/s, " << 1000. * total_nodes / time << " nodes/s)";
+	}
+	std::cout << std::endl;
+	return (number_invalid == 0) ? 0 : 1;
+}
+
+//----------------------------------------------------------------------------
+
+int main(int argc, char ** argv) {
+	const std::string command = (argc >= 2) ? argv[1] : "";
+	if (command == "bench") {
+		init_bench_variables(argc, argv);
+	} else if (command == "perft") {
+		init_perft_variables(argc, argv);
+	} else if (command == "match") {
+		init_match_variables(argc, argv);
+	} else if (command == "book") {
+		init_book_variables(argc, argv);
+	} else if (command == "train") {
+		init_train_variables(argc, argv);
+	} else if (command == "analyze") {
+		init_analyze_variables(argc, argv);
+	} else {
+		std::cout << USAGE;
+		return (command.empty() or command == "help") ? 0 : 1;
+	}
+	init_engine();
+	thread_pool pool(NUMBER_PROCESSOR);
+	POOL = &pool;
+	if (command == "bench") {
+		return run_bench();
+	} else if (command == "perft") {
+		return run_perft();
+	} else if (command == "book") {
+		return run_book();
+	} else if (command == "train") {
+		return run_train();
+	} else if (command == "analyze") {
+		return run_analyze();
+	}
+	return run_match();
+}
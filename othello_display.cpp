@@ -0,0 +1,201 @@
+/*
+	Othello display (see othello_display.h)
+*/
+
+#include "othello_display.h"
+#include <iostream>   // cout (flushed before a frame)
+#include <algorithm>  // fill(), copy()
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>  // WriteConsoleOutput()
+#else
+#include <unistd.h>   // write(), isatty()
+#include <termios.h>  // tcgetattr(), tcsetattr()
+#endif
+
+//----------------------------------------------------------------------------
+// Frame
+
+console_screen::console_screen(const int width, const int height) : _width(width), _height(height), _frame(width * height), _shown(width * height), _valid(false), _x(0), _y(0), _color(0x07) {
+	_changed.reserve(width * height);
+	clear(0x07, 0x00);
+}
+
+void console_screen::clear(const unsigned int textcol, const unsigned int backcol) {
+	color(textcol, backcol);
+	const screen_cell blank = {' ', _color};
+	std::fill(_frame.begin(), _frame.end(), blank);
+	_x = 0;
+	_y = 0;
+}
+
+void console_screen::put(const char c) {
+	// the cells out of the frame are ignored
+	if (_x >= 0 and _x < _width and _y >= 0 and _y < _height) {
+		const screen_cell cell = {c, _color};
+		_frame[_y * _width + _x] = cell;
+	}
+	_x++;
+}
+
+void console_screen::put(const std::string& s) {
+	for (const char c : s) {
+		put(c);
+	}
+}
+
+void console_screen::present() {
+	_changed.clear();
+	for (int i = 0; i < _width * _height; i++) {
+		if (not _valid or not (_frame[i] == _shown[i])) {
+			_changed.push_back(i);
+		}
+	}
+	if (not _changed.empty()) {
+		// the text already written to cout goes first
+		std::cout.flush();
+		draw(_changed, not _valid);
+	}
+	std::copy(_frame.begin(), _frame.end(), _shown.begin());
+	_valid = true;
+}
+
+//----------------------------------------------------------------------------
+// Windows console
+// the rectangle enclosing the changed cells is written by one WriteConsoleOutput()
+
+#ifdef _WIN32
+class windows_screen : public console_screen {
+public:
+	// constructor
+	windows_screen(const int width, const int height) : console_screen(width, height), _output(GetStdHandle(STD_OUTPUT_HANDLE)), _buffer(width * height) {}
+protected:
+	void draw(const std::vector<int>& changed, const bool) {
+		int left = _width;
+		int top = _height;
+		int right = -1;
+		int bottom = -1;
+		for (const int i : changed) {
+			left = std::min(left, i % _width);
+			right = std::max(right, i % _width);
+			top = std::min(top, i / _width);
+			bottom = std::max(bottom, i / _width);
+		}
+		for (int y = top; y <= bottom; y++) {
+			for (int x = left; x <= right; x++) {
+				_buffer[y * _width + x].Char.AsciiChar = _frame[y * _width + x]._char;
+				_buffer[y * _width + x].Attributes = _frame[y * _width + x]._color;
+			}
+		}
+		const COORD size = {(short) _width, (short) _height};
+		const COORD from = {(short) left, (short) top};
+		SMALL_RECT rect = {(short) left, (short) top, (short) right, (short) bottom};
+		WriteConsoleOutputA(_output, _buffer.data(), size, from, &rect);
+		const COORD below = {0, (short) _height};
+		SetConsoleCursorPosition(_output, below);
+	}
+private:
+	HANDLE _output;
+	std::vector<CHAR_INFO> _buffer;
+};
+
+#else
+//----------------------------------------------------------------------------
+// ANSI terminal
+// the changed cells are sent as one string: a cursor move before each run of
+// consecutive cells, a color change when the color differs from the previous
+// cell; the box drawing characters of code page 437 are sent in UTF-8. the
+// echo of the keys is turned off (termios), so that they do not garble the frame
+
+class ansi_screen : public console_screen {
+public:
+	// constructor: hide the cursor, turn the echo off
+	ansi_screen(const int width, const int height) : console_screen(width, height) {
+		_terminal = isatty(STDIN_FILENO) and tcgetattr(STDIN_FILENO, &_saved) == 0;
+		if (_terminal) {
+			termios no_echo = _saved;
+			no_echo.c_lflag &= ~ECHO;
+			tcsetattr(STDIN_FILENO, TCSANOW, &no_echo);
+		}
+		_text.reserve(16 * width * height);
+		send("\x1b[?25l");
+	}
+	// destructor: restore the colors, the cursor and the echo
+	~ansi_screen() {
+		send("\x1b[0m\x1b[?25h");
+		if (_terminal) {
+			tcsetattr(STDIN_FILENO, TCSANOW, &_saved);
+		}
+	}
+protected:
+	void draw(const std::vector<int>& changed, const bool whole) {
+		_text.clear();
+		if (whole) {
+			_text += "\x1b[0m\x1b[H\x1b[2J";
+		}
+		int next = -1; // index of the cell at the cursor
+		int color = -1;
+		for (const int i : changed) {
+			const screen_cell& cell = _frame[i];
+			if (i != next) {
+				_text += "\x1b[" + std::to_string(i / _width + 1) + ";" + std::to_string(i % _width + 1) + "H";
+			}
+			if (cell._color != color) {
+				_text += "\x1b[" + std::to_string(ansi_color(cell._color & 0x0F, 30)) + ";" + std::to_string(ansi_color(cell._color >> 4, 40)) + "m";
+				color = cell._color;
+			}
+			append(_text, cell._char);
+			next = ((i + 1) % _width == 0) ? -1 : i + 1;
+		}
+		_text += "\x1b[0m\x1b[" + std::to_string(_height + 1) + ";1H";
+		send(_text);
+	}
+private:
+	bool _terminal; // stdin is a terminal, whose settings are saved
+	termios _saved;
+	std::string _text;
+	static int ansi_color(const int windows_color, const int base) {
+		// Windows: blue 1, green 2, red 4, intensity 8; ANSI: red 1, green 2, blue 4, bright from 60 on
+		const int rgb = ((windows_color & 4) ? 1 : 0) | (windows_color & 2) | ((windows_color & 1) ? 4 : 0);
+		return base + rgb + ((windows_color & 8) ? 60 : 0);
+	}
+	static void append(std::string& text, const char c) {
+		// append c to text, the characters of code page 437 used by the game in UTF-8
+		switch ((unsigned char) c) {
+			case 179: text += "│"; break;
+			case 180: text += "┤"; break;
+			case 191: text += "┐"; break;
+			case 192: text += "└"; break;
+			case 193: text += "┴"; break;
+			case 194: text += "┬"; break;
+			case 195: text += "├"; break;
+			case 196: text += "─"; break;
+			case 197: text += "┼"; break;
+			case 217: text += "┘"; break;
+			case 218: text += "┌"; break;
+			case 219: text += "█"; break;
+			default: text += ((unsigned char) c < 128) ? c : '?'; break;
+		}
+	}
+	static void send(const std::string& text) {
+		// one write(), repeated only if the terminal takes part of the text
+		size_t done = 0;
+		while (done < text.size()) {
+			const ssize_t n = write(STDOUT_FILENO, text.data() + done, text.size() - done);
+			if (n <= 0) {
+				break;
+			}
+			done += n;
+		}
+	}
+};
+#endif
+
+std::unique_ptr<console_screen> create_console_screen(const int width, const int height) {
+#ifdef _WIN32
+	return std::unique_ptr<console_screen>(new windows_screen(width, height));
+#else
+	return std::unique_ptr<console_screen>(new ansi_screen(width, height));
+#endif
+}
@@ -0,0 +1,62 @@
+/*
+	Othello display: the frame of the game is drawn in an off-screen buffer of
+	cells (character and colors), and present() sends only the cells changed
+	since the last frame, with a single write: WriteConsoleOutput() to the
+	Windows console, or one string of ANSI escape sequences to a terminal
+	(Linux, with termios)
+*/
+
+#ifndef OTHELLO_DISPLAY_H
+#define OTHELLO_DISPLAY_H
+
+#include <vector>
+#include <string>
+#include <memory>     // unique_ptr
+
+struct screen_cell {
+	char _char; // character, in code page 437 (the box drawing characters of the Windows console)
+	unsigned char _color; // (background << 4) | foreground, as the attributes of the Windows console
+	inline bool operator==(const screen_cell& c) const {return _char == c._char and _color == c._color;}
+};
+
+class console_screen {
+	// frame of width x height cells, at the top left corner of the console
+	// the cells are written at a cursor, as on a console: put() moves it right, new_line() to the next line
+public:
+	// constructor
+	console_screen(const int width, const int height);
+	virtual ~console_screen() {}
+	// getters
+	inline int get_width() const {return _width;}
+	inline int get_height() const {return _height;}
+	// helper functions
+	void clear(const unsigned int textcol, const unsigned int backcol); // fill the frame with spaces; the cursor goes to the top left corner
+	inline void color(const unsigned int textcol, const unsigned int backcol) {_color = (unsigned char) ((backcol << 4) | textcol);}
+	inline void cursor(const int x, const int y) {_x = x; _y = y;}
+	void put(const char c);
+	void put(const std::string& s);
+	inline void new_line() {_x = 0; _y++;}
+	// send the cells changed since the last frame (all of them after invalidate()), and leave the
+	// cursor of the console at the start of the line below the frame
+	void present();
+	// the console was changed by other means (e.g. cleared): the next frame is sent whole
+	inline void invalidate() {_valid = false;}
+protected:
+	// send the cells of _frame whose indexes (y * _width + x) are in changed, with a single write
+	virtual void draw(const std::vector<int>& changed, const bool whole) = 0;
+	const int _width;
+	const int _height;
+	std::vector<screen_cell> _frame; // frame being drawn (back buffer)
+	std::vector<screen_cell> _shown; // frame on the console (front buffer)
+private:
+	std::vector<int> _changed;
+	bool _valid; // _shown is what the console shows
+	int _x;
+	int _y;
+	unsigned char _color;
+};
+
+// return the screen of the console (Windows) or of the terminal (other platforms)
+std::unique_ptr<console_screen> create_console_screen(const int width, const int height);
+
+#endif
@@ -0,0 +1,2183 @@
+/*
+	Othello engine (see othello_engine.h)
+*/
+
+#include "othello_engine.h"
+#include <numeric>    // accumulate()
+#include <cassert>    // assert()
+#include <cstdlib>    // malloc(), free()
+#include <new>        // bad_alloc
+#include <cmath>      // log(), sqrt()
+#include <fstream>    // ofstream
+#include <sstream>    // ostringstream (telemetry)
+#include <iomanip>    // setprecision() (telemetry)
+#include <cctype>     // isspace(), isdigit(), tolower() (transcripts)
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>  // CreateFileMapping(), MapViewOfFile() (opening book)
+#else
+#include <fcntl.h>    // open() (opening book)
+#include <unistd.h>   // close()
+#include <sys/mman.h> // mmap(), munmap()
+#include <sys/stat.h> // fstat()
+#endif
+
+int BOARD_SIZE = 8;
+int NUMBER_PROCESSOR = 4;
+int NUMBER_MONTE_CARLO_PATH = 20000;
+char AI_MODE = 'F';
+int MOVE_TIME = 0;
+int GAME_TIME = 0;
+long long GAME_TIME_LEFT = 0;
+int ENDGAME_EMPTY = 14;
+int HASH_SIZE = 64;
+int ROLLOUT_DEPTH = 0;
+bool ROOT_PRUNING = true;
+int PONDER_CPU = 0;
+std::string TELEMETRY_FILE = "";
+
+//----------------------------------------------------------------------------
+// Random numbers
+
+uint64_t MASTER_SEED = 0;
+thread_local random_generator RANDOM;
+random_generator RANDOM_STREAMS; // source of the streams, seeded with MASTER_SEED
+std::mutex RANDOM_STREAMS_MUTEX;
+
+random_generator new_random_stream() {
+	// return the next independent stream derived from MASTER_SEED
+	std::lock_guard<std::mutex> lock(RANDOM_STREAMS_MUTEX);
+	const random_generator stream = RANDOM_STREAMS;
+	RANDOM_STREAMS.jump();
+	return stream;
+}
+
+//----------------------------------------------------------------------------
+// Rules
+
+const std::vector<std::tuple<int, int>> deltas = {{0,-1}, {1,-1}, {1,0}, {1,1}, {0,1}, {-1,1}, {-1,0}, {-1,-1}};
+
+void othello_game::set_othelloboard_piece(const int row, const int col, const piece p) {
+	// set square (row,col) to p, and update the counts of pieces and the frontier around it
+	const piece old = _othelloboard_piece[row][col];
+	if (old == p) {
+		return;
+	}
+	_othelloboard_piece[row][col] = p;
+	_count[(int) old]--;
+	_count[(int) p]++;
+	const int square = row * BOARD_SIZE + col;
+	for (std::tuple<int, int> delta : deltas) {
+		const int i = row + std::get<0>(delta);
+		const int j = col + std::get<1>(delta);
+		if (i < 0 or i >= BOARD_SIZE or j < 0 or j >= BOARD_SIZE) {
+			continue;
+		}
+		const int neighbour = i * BOARD_SIZE + j;
+		if (old != piece::EMPTY) {
+			_neighbours[(int) old - 1][neighbour]--;
+		}
+		if (p != piece::EMPTY) {
+			_neighbours[(int) p - 1][neighbour]++;
+		}
+		if (_othelloboard_piece[i][j] == piece::EMPTY) {
+			for (int k = 0; k < 2; k++) {
+				if (_neighbours[k][neighbour] > 0) {
+					_frontier[k][neighbour / 64] |= 1ULL << (neighbour % 64);
+				} else {
+					_frontier[k][neighbour / 64] &= ~(1ULL << (neighbour % 64));
+				}
+			}
+		}
+	}
+	for (int k = 0; k < 2; k++) {
+		if (p == piece::EMPTY and _neighbours[k][square] > 0) {
+			_frontier[k][square / 64] |= 1ULL << (square % 64);
+		} else {
+			_frontier[k][square / 64] &= ~(1ULL << (square % 64));
+		}
+	}
+}
+
+std::vector<std::tuple<int, int>> othello_game::valid_moves(const piece p) const {
+	// return the vector of all valid moves for p, in the order of the squares
+	// a valid move is an empty square next to a piece of the opponent: only these squares are looked at
+	std::vector<std::tuple<int, int>> moves;
+	const uint64_t *candidates = _frontier[(p == piece::X) ? 1 : 0];
+	for (int w = 0; w < (BOARD_SIZE * BOARD_SIZE + 63) / 64; w++) {
+		for (uint64_t bits = candidates[w]; bits != 0; bits &= bits - 1) {
+			const int square = w * 64 + __builtin_ctzll(bits);
+			const int i = square / BOARD_SIZE;
+			const int j = square % BOARD_SIZE;
+			// check if (i,j) is a valid move
+			bool valid = false;
+			for (std::tuple<int, int> delta : deltas) {
+				const int di = std::get<0>(delta);
+				const int dj = std::get<1>(delta);
+				for (int k = 1; k < BOARD_SIZE; k++) {
+					const int new_i = i + k * di;
+					const int new_j = j + k * dj;
+					if (new_i >= 0 and new_i < BOARD_SIZE and new_j >= 0 and new_j < BOARD_SIZE) {
+						if (k == 1) {
+							if (get_othelloboard_piece(new_i, new_j) == piece::EMPTY or get_othelloboard_piece(new_i, new_j) == p) {
+								break;
+							}
+						} else if (get_othelloboard_piece(new_i, new_j) == piece::EMPTY) {
+							break;
+						} else if (get_othelloboard_piece(new_i, new_j) == p) {
+							valid = true;
+							break;
+						}
+					} else {
+						break;
+					}
+				}
+				if (valid) {break;}
+			}
+			if (valid) {
+				moves.push_back(std::make_tuple(i, j));
+			}
+		}
+	}
+	TELEMETRY_COUNT(TELEMETRY_MOVES, moves.size());
+	return moves;
+}
+
+std::vector<std::tuple<int, int>> othello_game::flipped_pieces(const int row, const int col, const piece p) const {
+	// return the pieces flipped by move (row,col) for p, in the order they are flipped
+	// it is assumed to be a valid move
+	std::vector<std::tuple<int, int>> flipped;
+	for (std::tuple<int, int> delta : deltas) {
+		const int drow = std::get<0>(delta);
+		const int dcol = std::get<1>(delta);
+		for (int k = 1; k < BOARD_SIZE; k++) {
+			const int new_row = row + k * drow;
+			const int new_col = col + k * dcol;
+			if (new_row >= 0 and new_row < BOARD_SIZE and new_col >= 0 and new_col < BOARD_SIZE) {
+				if (k == 1) {
+					if (get_othelloboard_piece(new_row, new_col) == piece::EMPTY or get_othelloboard_piece(new_row, new_col) == p) {
+						break;
+					}
+				} else if (get_othelloboard_piece(new_row, new_col) == piece::EMPTY) {
+					break;
+				} else if (get_othelloboard_piece(new_row, new_col) == p) {
+					for (int k1 = 1; k1 < k; k1++) {
+						flipped.push_back({row + k1 * drow, col + k1 * dcol});
+					}
+					break;
+				}
+			} else {
+				break;
+			}
+		}
+	}
+	return flipped;
+}
+
+void othello_game::execute_move(const int row, const int col, const piece p, uint64_t *flipped) {
+	// execute move (row,col) for p: flip the pieces of flipped_pieces(), without building the vector
+	// it is assumed to be a valid move
+	if (flipped != nullptr) {
+		std::fill(flipped, flipped + SQUARE_WORDS, 0);
+	}
+	for (std::tuple<int, int> delta : deltas) {
+		const int drow = std::get<0>(delta);
+		const int dcol = std::get<1>(delta);
+		for (int k = 1; k < BOARD_SIZE; k++) {
+			const int new_row = row + k * drow;
+			const int new_col = col + k * dcol;
+			if (new_row < 0 or new_row >= BOARD_SIZE or new_col < 0 or new_col >= BOARD_SIZE or get_othelloboard_piece(new_row, new_col) == piece::EMPTY) {
+				break;
+			} else if (get_othelloboard_piece(new_row, new_col) == p) {
+				for (int k1 = 1; k1 < k; k1++) {
+					set_othelloboard_piece(row + k1 * drow, col + k1 * dcol, p);
+					if (flipped != nullptr) {
+						const int square = (row + k1 * drow) * BOARD_SIZE + col + k1 * dcol;
+						flipped[square / 64] |= 1ULL << (square % 64);
+					}
+				}
+				TELEMETRY_COUNT(TELEMETRY_FLIPS, k - 1);
+				break;
+			}
+		}
+	}
+}
+
+std::string move_name(const int row, const int col) {
+	if (row < 0 or col < 0) {
+		return "pass";
+	}
+	return std::string(1, (char) ('a' + col)) + std::to_string(row + 1);
+}
+
+std::string othello_game::get_position(const piece turn) const {
+	// return the position as text: one character per square (X, O or -), row by row, a space and the player to move
+	std::string position;
+	for (int i = 0; i < BOARD_SIZE; i++) {
+		for (int j = 0; j < BOARD_SIZE; j++) {
+			const piece p = get_othelloboard_piece(i, j);
+			position += (p == piece::X) ? 'X' : ((p == piece::O) ? 'O' : '-');
+		}
+	}
+	position += ' ';
+	position += (turn == piece::X) ? 'X' : 'O';
+	return position;
+}
+
+bool othello_game::set_position(const std::string& position, piece &turn) {
+	// set the board and the player to move from text in the format of get_position()
+	// 'X' is also read as '*' or 'x', 'O' as 'o' or '0', and '-' as '.'; spaces are ignored
+	// return false (and leave the game unchanged) if position is not a valid position for BOARD_SIZE
+	othello_game game;
+	int square = 0;
+	size_t i = 0;
+	for (; i < position.size() and square < BOARD_SIZE * BOARD_SIZE; i++) {
+		const char c = position[i];
+		piece p;
+		if (c == 'X' or c == 'x' or c == '*') {
+			p = piece::X;
+		} else if (c == 'O' or c == 'o' or c == '0') {
+			p = piece::O;
+		} else if (c == '-' or c == '.') {
+			p = piece::EMPTY;
+		} else if (c == ' ' or c == '\t') {
+			continue;
+		} else {
+			return false;
+		}
+		game.set_othelloboard_piece(square / BOARD_SIZE, square % BOARD_SIZE, p);
+		square++;
+	}
+	while (i < position.size() and (position[i] == ' ' or position[i] == '\t')) {
+		i++;
+	}
+	if (square < BOARD_SIZE * BOARD_SIZE or i >= position.size()) {
+		return false;
+	}
+	if (position[i] == 'X' or position[i] == 'x' or position[i] == '*') {
+		turn = piece::X;
+	} else if (position[i] == 'O' or position[i] == 'o' or position[i] == '0') {
+		turn = piece::O;
+	} else {
+		return false;
+	}
+	*this = game;
+	return true;
+}
+
+//----------------------------------------------------------------------------
+// Game record
+
+game_record::game_record() : _turn(piece::X), _ply(0) {
+	// the longest game fills every square, with no pass recorded
+	_log.reserve(MAX_BOARD_SIZE * MAX_BOARD_SIZE);
+}
+
+void game_record::play(const int row, const int col) {
+	// the turn goes to the opponent, back to the player if the opponent cannot move, and the game is over if neither can
+	const piece other = (_turn == piece::X) ? piece::O : piece::X;
+	_log.resize(_ply + 1);
+	game_ply& ply = _log[_ply];
+	ply._row = (int8_t) row;
+	ply._col = (int8_t) col;
+	ply._player = _turn;
+	_game.set_othelloboard_piece(row, col, _turn);
+	_game.execute_move(row, col, _turn, ply._flipped);
+	if (not _game.valid_moves(other).empty()) {
+		ply._turn = other;
+	} else if (not _game.valid_moves(_turn).empty()) {
+		ply._turn = _turn;
+	} else {
+		ply._turn = piece::EMPTY;
+	}
+	_turn = ply._turn;
+	_ply++;
+}
+
+void game_record::undo() {
+	// the flipped pieces go back to the opponent of the player, and the square of the move is emptied
+	const game_ply& ply = _log[--_ply];
+	const piece other = (ply._player == piece::X) ? piece::O : piece::X;
+	for (int w = 0; w < SQUARE_WORDS; w++) {
+		for (uint64_t bits = ply._flipped[w]; bits != 0; bits &= bits - 1) {
+			const int square = w * 64 + __builtin_ctzll(bits);
+			_game.set_othelloboard_piece(square / BOARD_SIZE, square % BOARD_SIZE, other);
+		}
+	}
+	_game.set_othelloboard_piece(ply._row, ply._col, piece::EMPTY);
+	_turn = ply._player;
+}
+
+void game_record::redo() {
+	const game_ply& ply = _log[_ply++];
+	_game.set_othelloboard_piece(ply._row, ply._col, ply._player);
+	for (int w = 0; w < SQUARE_WORDS; w++) {
+		for (uint64_t bits = ply._flipped[w]; bits != 0; bits &= bits - 1) {
+			const int square = w * 64 + __builtin_ctzll(bits);
+			_game.set_othelloboard_piece(square / BOARD_SIZE, square % BOARD_SIZE, ply._player);
+		}
+	}
+	_turn = ply._turn;
+}
+
+std::string game_record::transcript() const {
+	std::string text;
+	for (int i = 0; i < _ply; i++) {
+		text += move_name(_log[i]._row, _log[i]._col);
+	}
+	return text;
+}
+
+bool game_record::set_transcript(const std::string& text) {
+	// moves written by their names (e.g. f5d6c3, F5 D6 C3), spaces allowed; a player without a valid move passes
+	game_record record;
+	size_t i = 0;
+	while (i < text.size()) {
+		if (std::isspace((unsigned char) text[i])) {
+			i++;
+			continue;
+		}
+		const int col = std::tolower((unsigned char) text[i++]) - 'a';
+		int row = 0;
+		int digits = 0;
+		while (i < text.size() and std::isdigit((unsigned char) text[i]) and digits < 3) {
+			row = 10 * row + (text[i++] - '0');
+			digits++;
+		}
+		row--;
+		if (digits == 0 or row < 0 or row >= BOARD_SIZE or col < 0 or col >= BOARD_SIZE or record._turn == piece::EMPTY) {
+			return false;
+		}
+		const std::vector<std::tuple<int, int>> moves = record._game.valid_moves(record._turn);
+		if (std::find(moves.begin(), moves.end(), std::make_tuple(row, col)) == moves.end()) {
+			return false;
+		}
+		record.play(row, col);
+	}
+	*this = std::move(record);
+	return true;
+}
+
+void game_record::reset(const othello_game& game, const piece turn) {
+	const piece other = (turn == piece::X) ? piece::O : piece::X;
+	_game = game;
+	if (not _game.valid_moves(turn).empty()) {
+		_turn = turn;
+	} else if (not _game.valid_moves(other).empty()) {
+		_turn = other;
+	} else {
+		_turn = piece::EMPTY;
+	}
+	_log.clear();
+	_ply = 0;
+}
+
+//----------------------------------------------------------------------------
+// Zobrist hashing
+
+const zobrist_keys ZOBRIST;
+
+//----------------------------------------------------------------------------
+// Symmetries
+
+template <int N>
+int game_symmetries(const othello_game& othello) {
+	const bitboard<N> board(othello);
+	return position_symmetries(board.get_pieces(piece::X), board.get_pieces(piece::O));
+}
+
+std::vector<std::tuple<int, int>> distinct_moves(const othello_game& othello, const piece p) {
+	std::vector<std::tuple<int, int>> moves = othello.valid_moves(p);
+	int symmetries;
+	switch (BOARD_SIZE) {
+		case 4: symmetries = game_symmetries<4>(othello); break;
+		case 6: symmetries = game_symmetries<6>(othello); break;
+		case 8: symmetries = game_symmetries<8>(othello); break;
+		case 10: symmetries = game_symmetries<10>(othello); break;
+		case 12: symmetries = game_symmetries<12>(othello); break;
+		case 14: symmetries = game_symmetries<14>(othello); break;
+		default: symmetries = game_symmetries<16>(othello); break;
+	}
+	if (symmetries != 1) {
+		moves.erase(std::remove_if(moves.begin(), moves.end(), [symmetries](const std::tuple<int, int>& move) {
+			return not distinct_square(std::get<0>(move) * BOARD_SIZE + std::get<1>(move), symmetries, BOARD_SIZE);
+		}), moves.end());
+	}
+	return moves;
+}
+
+//----------------------------------------------------------------------------
+// Telemetry counters
+
+const char *TELEMETRY_COUNTER_NAME[TELEMETRY_COUNTERS] = {"moves", "flips", "allocations"};
+
+#ifdef OTHELLO_TELEMETRY
+std::mutex COUNTERS_MUTEX; // protects the list below and the counts of the threads which ended
+thread_counters *COUNTERS_LIST = nullptr;
+long long COUNTERS_ENDED[TELEMETRY_COUNTERS] = {0};
+thread_local thread_counters COUNTERS;
+
+thread_counters::thread_counters() {
+	for (int c = 0; c < TELEMETRY_COUNTERS; c++) {
+		_count[c].store(0, std::memory_order_relaxed);
+	}
+	std::lock_guard<std::mutex> lock(COUNTERS_MUTEX);
+	_next = COUNTERS_LIST;
+	COUNTERS_LIST = this;
+}
+
+thread_counters::~thread_counters() {
+	std::lock_guard<std::mutex> lock(COUNTERS_MUTEX);
+	for (int c = 0; c < TELEMETRY_COUNTERS; c++) {
+		COUNTERS_ENDED[c] += _count[c].load(std::memory_order_relaxed);
+	}
+	for (thread_counters **t = &COUNTERS_LIST; *t != nullptr; t = &(*t)->_next) {
+		if (*t == this) {
+			*t = _next;
+			break;
+		}
+	}
+}
+#endif
+
+telemetry_counters telemetry_totals() {
+	telemetry_counters totals = {{0}};
+#ifdef OTHELLO_TELEMETRY
+	std::lock_guard<std::mutex> lock(COUNTERS_MUTEX);
+	for (int c = 0; c < TELEMETRY_COUNTERS; c++) {
+		totals._count[c] = COUNTERS_ENDED[c];
+	}
+	for (const thread_counters *t = COUNTERS_LIST; t != nullptr; t = t->_next) {
+		for (int c = 0; c < TELEMETRY_COUNTERS; c++) {
+			totals._count[c] += t->_count[c].load(std::memory_order_relaxed);
+		}
+	}
+#endif
+	return totals;
+}
+
+//----------------------------------------------------------------------------
+// Allocation counter (debug builds only: compile with -DOTHELLO_DEBUG; also counted by the telemetry)
+
+#ifdef OTHELLO_DEBUG
+thread_local long long ALLOCATION_COUNT = 0;
+#endif
+
+#if defined(OTHELLO_DEBUG) or defined(OTHELLO_TELEMETRY)
+void *operator new(std::size_t size) {
+#ifdef OTHELLO_DEBUG
+	ALLOCATION_COUNT++;
+#endif
+	TELEMETRY_COUNT(TELEMETRY_ALLOCATIONS, 1);
+	void *p = std::malloc(size ? size : 1);
+	if (p == nullptr) {throw std::bad_alloc();}
+	return p;
+}
+
+__attribute__((noinline)) void operator delete(void *p) noexcept {
+	// not inlined: once inlined in the callers of operator new, free() would look mismatched to the compiler
+	std::free(p);
+}
+#endif
+
+//----------------------------------------------------------------------------
+// Thread pool
+
+thread_local int thread_pool::WORKER_INDEX = -1;
+thread_local bool thread_pool::URGENT = false;
+
+thread_pool *POOL = nullptr;
+
+//----------------------------------------------------------------------------
+// Random paths
+
+template <int N>
+inline void random_path(bitboard<N>& board, piece turn, move_list<N>& moves, random_generator& rng) {
+	// play random moves on board until the end of the game; turn plays first
+	bool game_blocked = false;
+	while (true) {
+		moves.fill(board.valid_moves(turn));
+		if (moves._size == 0) {
+			// no possible move; pass
+			if (game_blocked) {
+				// no possible move twice; exit
+				break;
+			}
+			game_blocked = true;
+		} else {
+			// play one possible move randomly
+			const int rand_choice = rng.range(0, moves._size - 1);
+			board.make_move(moves._square[rand_choice], turn);
+			game_blocked = false;
+		}
+		turn = (turn == piece::X) ? piece::O : piece::X;
+	}
+}
+
+template <int N>
+inline bool cut_path(bitboard<N>& board, piece &turn, move_list<N>& moves, random_generator& rng, const int depth) {
+	// play at most depth random moves on board, as random_path(); return true if the game is over,
+	// false if the path is cut off, turn being the player to move
+	bool game_blocked = false;
+	int played = 0;
+	while (played < depth) {
+		moves.fill(board.valid_moves(turn));
+		if (moves._size == 0) {
+			if (game_blocked) {
+				return true;
+			}
+			game_blocked = true;
+		} else {
+			const int rand_choice = rng.range(0, moves._size - 1);
+			board.make_move(moves._square[rand_choice], turn);
+			game_blocked = false;
+			played++;
+		}
+		turn = (turn == piece::X) ? piece::O : piece::X;
+	}
+	return false;
+}
+
+template <int N>
+inline int path_result(bitboard<N>& board, piece turn, move_list<N>& moves, random_generator& rng, const rollout_cutoff& cutoff) {
+	// play a random path, turn playing first, cut off as cutoff says; return the final disc margin of X,
+	// or if the path is cut off, 1 or -1 drawn with the probability of a win estimated by the evaluator
+	if (cutoff.active() and not cut_path(board, turn, moves, rng, cutoff._depth)) {
+		const float win = cutoff._evaluator->win_probability(board, turn);
+		const bool win_x = ((rng.next() >> 40) < win * (1 << 24)) == (turn == piece::X);
+		return win_x ? 1 : -1;
+	}
+	random_path(board, turn, moves, rng);
+	return board.score_board(piece::X) - board.score_board(piece::O);
+}
+
+//----------------------------------------------------------------------------
+// Pattern evaluation
+
+std::string EVAL_FILE = "";
+pattern_evaluator EVALUATOR;
+
+void pattern_evaluator::reset(const int board_size) {
+	// each pattern is read from the 4 corners, an edge in its 2 directions
+	_board_size = board_size;
+	_instances.clear();
+	const int length = std::min(board_size, 8);
+	for (int corner = 0; corner < 4; corner++) {
+		const int row = (corner / 2 == 0) ? 0 : board_size - 1;
+		const int col = (corner % 2 == 0) ? 0 : board_size - 1;
+		const int drow = (row == 0) ? 1 : -1;
+		const int dcol = (col == 0) ? 1 : -1;
+		pattern_instance edge_row = {0, length, {}};
+		pattern_instance edge_col = {0, length, {}};
+		pattern_instance block = {1, 9, {}};
+		pattern_instance diagonal = {2, length, {}};
+		for (int k = 0; k < length; k++) {
+			edge_row._square[k] = row * board_size + col + k * dcol;
+			edge_col._square[k] = (row + k * drow) * board_size + col;
+			diagonal._square[k] = (row + k * drow) * board_size + col + k * dcol;
+		}
+		for (int k = 0; k < 9; k++) {
+			block._square[k] = (row + (k / 3) * drow) * board_size + col + (k % 3) * dcol;
+		}
+		_instances.push_back(edge_row);
+		_instances.push_back(edge_col);
+		_instances.push_back(block);
+		_instances.push_back(diagonal);
+	}
+	for (int pattern = 0; pattern < EVAL_PATTERN; pattern++) {
+		int size = 1;
+		for (int k = 0; k < ((pattern == 1) ? 9 : length); k++) {
+			size *= 3;
+		}
+		_weights[pattern].assign(size, 0.f);
+	}
+	_mobility = 0.f;
+	_bias.assign(board_size * board_size + 1, 0.f);
+	_deviation.assign(board_size * board_size + 1, 1.f);
+}
+
+bool pattern_evaluator::load(const std::string& file_name) {
+	// file: EVAL_MAGIC, board size and number of weights (32 bits each), then the weights (32 bits floats):
+	// the tables of the patterns, the weight of mobility, the biases and the deviations
+	_board_size = 0;
+	std::ifstream file(file_name, std::ios::binary);
+	char magic[8];
+	uint32_t header[2];
+	if (not file.read(magic, 8) or not std::equal(magic, magic + 8, EVAL_MAGIC) or not file.read((char *) header, sizeof(header))
+		or header[0] < 4 or header[0] > MAX_BOARD_SIZE or header[0] % 2 != 0) {
+		return false;
+	}
+	reset((int) header[0]);
+	size_t number_weight = 1 + _bias.size() + _deviation.size();
+	for (int pattern = 0; pattern < EVAL_PATTERN; pattern++) {
+		number_weight += _weights[pattern].size();
+	}
+	bool ok = (header[1] == number_weight);
+	for (int pattern = 0; ok and pattern < EVAL_PATTERN; pattern++) {
+		ok = (bool) file.read((char *) _weights[pattern].data(), (std::streamsize) (_weights[pattern].size() * sizeof(float)));
+	}
+	ok = ok and file.read((char *) &_mobility, sizeof(float)) and file.read((char *) _bias.data(), (std::streamsize) (_bias.size() * sizeof(float)))
+		and file.read((char *) _deviation.data(), (std::streamsize) (_deviation.size() * sizeof(float)));
+	for (const float d : _deviation) {
+		ok = ok and d > 0.f;
+	}
+	if (not ok) {
+		_board_size = 0;
+	}
+	return ok;
+}
+
+bool pattern_evaluator::save(const std::string& file_name) const {
+	std::ofstream file(file_name, std::ios::binary | std::ios::trunc);
+	uint32_t header[2] = {(uint32_t) _board_size, (uint32_t) (1 + _bias.size() + _deviation.size())};
+	for (int pattern = 0; pattern < EVAL_PATTERN; pattern++) {
+		header[1] += (uint32_t) _weights[pattern].size();
+	}
+	file.write(EVAL_MAGIC, 8);
+	file.write((const char *) header, sizeof(header));
+	for (int pattern = 0; pattern < EVAL_PATTERN; pattern++) {
+		file.write((const char *) _weights[pattern].data(), (std::streamsize) (_weights[pattern].size() * sizeof(float)));
+	}
+	file.write((const char *) &_mobility, sizeof(float));
+	file.write((const char *) _bias.data(), (std::streamsize) (_bias.size() * sizeof(float)));
+	file.write((const char *) _deviation.data(), (std::streamsize) (_deviation.size() * sizeof(float)));
+	return (bool) file;
+}
+
+void pattern_evaluator::features(const othello_game& othello, const piece turn, int *indexes, int &mobility, int &empty) const {
+	// same as for a bitboard, with the rules of othello_game
+	const piece other = (turn == piece::X) ? piece::O : piece::X;
+	const int board_size = _board_size;
+	read_patterns([&othello, turn, other, board_size] (const int square) {
+		const piece p = othello.get_othelloboard_piece(square / board_size, square % board_size);
+		return (p == turn) ? 1 : ((p == other) ? 2 : 0);
+	}, indexes);
+	mobility = (int) othello.valid_moves(turn).size() - (int) othello.valid_moves(other).size();
+	empty = othello.score_board(piece::EMPTY);
+}
+
+//----------------------------------------------------------------------------
+// Batched random paths
+// boards of at most 8 x 8 fit in one 64 bits word: the independent random
+// paths of score_move() are then played L at a time, one per lane of a vector
+// of words (L = 4 with AVX2, 8 with AVX-512), the move generation and the
+// flips being computed for all the lanes at once; a lane restarts from the
+// root position as soon as its path ends. the instruction set is chosen at
+// runtime; the other processors (and board sizes) play the paths one by one
+
+bool SIMD_PLAYOUTS = true;
+
+enum class simd_kind {NONE, AVX2, AVX512};
+
+simd_kind detect_simd() {
+	// return the widest instruction set usable for the batched random paths
+	// (none on 64 bits Windows: GCC does not align its stack for the AVX registers there)
+#if defined(__GNUC__) and (defined(__x86_64__) or defined(__i386__)) and not defined(_WIN64)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f")) {
+		return simd_kind::AVX512;
+	}
+	if (__builtin_cpu_supports("avx2")) {
+		return simd_kind::AVX2;
+	}
+#endif
+	return simd_kind::NONE;
+}
+
+const simd_kind SIMD = detect_simd();
+
+const char *simd_playouts_name() {
+	switch (SIMD) {
+		case simd_kind::AVX512: return "AVX-512, 8 paths at a time";
+		case simd_kind::AVX2: return "AVX2, 4 paths at a time";
+		default: return "none";
+	}
+}
+
+#if defined(__GNUC__) and (defined(__x86_64__) or defined(__i386__)) and not defined(_WIN64)
+#define OTHELLO_SIMD
+#define ALWAYS_INLINE inline __attribute__((always_inline))
+// the helpers below are always inlined in the kernels compiled for AVX: their vector arguments never go through the ABI
+// (the warning is given when the templates are instantiated, at the end of the file, hence no pop)
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+typedef uint64_t lanes_avx2 __attribute__((vector_size(32)));
+typedef uint64_t lanes_avx512 __attribute__((vector_size(64)));
+
+template <int N, int DIR, typename V> ALWAYS_INLINE V shift_lanes(const V& x, const V *masks) {
+	// move every square of every lane one step in the direction deltas[DIR] (see square_set::shift())
+	const int S = DELTA_ROW[DIR] * N + DELTA_COL[DIR];
+	return ((S > 0) ? (x << (S > 0 ? S : 0)) : (x >> (S > 0 ? 0 : -S))) & masks[DIR];
+}
+
+template <int N, int DIR, typename V> ALWAYS_INLINE V line_end_lanes(const V& own, const V& other, const V *masks) {
+	// see bitboard::line_end()
+	V line = shift_lanes<N, DIR>(own, masks) & other;
+	for (int k = 0; k < N - 3; k++) {
+		line |= shift_lanes<N, DIR>(line, masks) & other;
+	}
+	return shift_lanes<N, DIR>(line, masks);
+}
+
+template <int N, int DIR, typename V> ALWAYS_INLINE V flip_line_lanes(const V& move, const V& own, const V& other, const V *masks) {
+	// see bitboard::flip_line()
+	V line = shift_lanes<N, DIR>(move, masks) & other;
+	for (int k = 0; k < N - 3; k++) {
+		line |= shift_lanes<N, DIR>(line, masks) & other;
+	}
+	return line & (V) ((shift_lanes<N, DIR>(line, masks) & own) != 0);
+}
+
+template <int N, typename V, int L> ALWAYS_INLINE int batched_paths(const uint64_t root_p, const uint64_t root_other, const int number_path, random_generator& rng) {
+	// play number_path random paths from the root (p has just played), L at a time, and return the number won by p
+	V masks[8];
+	V board;
+	V own; // pieces of the player to move, in each lane
+	V other; // pieces of his opponent
+	V mover; // all ones in the lanes where p is the player to move
+	bool passed[L];
+	bool active[L];
+	for (int l = 0; l < L; l++) {
+		for (int dir = 0; dir < 8; dir++) {
+			masks[dir][l] = board_masks<N>::instance._direction[dir]._word[0];
+		}
+		board[l] = board_masks<N>::instance._board._word[0];
+	}
+	int started = 0;
+	int number_active = 0;
+	int count_win = 0;
+	for (int l = 0; l < L; l++) {
+		own[l] = root_other;
+		other[l] = root_p;
+		mover[l] = 0;
+		passed[l] = false;
+		active[l] = (started < number_path);
+		started += active[l] ? 1 : 0;
+		number_active += active[l] ? 1 : 0;
+	}
+	while (number_active > 0) {
+		V moves = line_end_lanes<N, 0>(own, other, masks) | line_end_lanes<N, 1>(own, other, masks) | line_end_lanes<N, 2>(own, other, masks) | line_end_lanes<N, 3>(own, other, masks);
+		moves |= line_end_lanes<N, 4>(own, other, masks) | line_end_lanes<N, 5>(own, other, masks) | line_end_lanes<N, 6>(own, other, masks) | line_end_lanes<N, 7>(own, other, masks);
+		moves &= board & ~(own | other);
+		// one move per lane: a random move, or nothing for a pass and for the end of a path
+		V move;
+		for (int l = 0; l < L; l++) {
+			move[l] = 0;
+			if (not active[l]) {
+				continue;
+			}
+			uint64_t m = moves[l];
+			TELEMETRY_COUNT(TELEMETRY_MOVES, __builtin_popcountll(m));
+			if (m != 0) {
+				int n = rng.range(0, __builtin_popcountll(m) - 1);
+				while (n-- > 0) {
+					m &= m - 1;
+				}
+				move[l] = m & -m;
+				passed[l] = false;
+			} else if (not passed[l]) {
+				const uint64_t swap = own[l];
+				own[l] = other[l];
+				other[l] = swap;
+				mover[l] = ~mover[l];
+				passed[l] = true;
+			} else {
+				// end of the path; the lane restarts from the root
+				const int score_p = __builtin_popcountll(mover[l] ? own[l] : other[l]);
+				const int score_other = __builtin_popcountll(mover[l] ? other[l] : own[l]);
+				if (computer_win(score_other, score_p) == 1) {
+					count_win++;
+				}
+				if (started < number_path) {
+					own[l] = root_other;
+					other[l] = root_p;
+					mover[l] = 0;
+					passed[l] = false;
+					started++;
+				} else {
+					active[l] = false;
+					number_active--;
+				}
+			}
+		}
+		V flipped = flip_line_lanes<N, 0>(move, own, other, masks) | flip_line_lanes<N, 1>(move, own, other, masks) | flip_line_lanes<N, 2>(move, own, other, masks) | flip_line_lanes<N, 3>(move, own, other, masks);
+		flipped |= flip_line_lanes<N, 4>(move, own, other, masks) | flip_line_lanes<N, 5>(move, own, other, masks) | flip_line_lanes<N, 6>(move, own, other, masks) | flip_line_lanes<N, 7>(move, own, other, masks);
+#ifdef OTHELLO_TELEMETRY
+		for (int l = 0; l < L; l++) {
+			TELEMETRY_COUNT(TELEMETRY_FLIPS, __builtin_popcountll(flipped[l]));
+		}
+#endif
+		// the lanes which played a move swap the player to move
+		const V played = (V) (move != 0);
+		const V next_own = other & ~flipped;
+		const V next_other = own | flipped | move;
+		own = (played & next_own) | (~played & own);
+		other = (played & next_other) | (~played & other);
+		mover ^= played;
+	}
+	return count_win;
+}
+
+template <int N> __attribute__((target("avx2"))) int batched_paths_avx2(const uint64_t root_p, const uint64_t root_other, const int number_path, random_generator& rng) {
+	return batched_paths<N, lanes_avx2, 4>(root_p, root_other, number_path, rng);
+}
+
+template <int N> __attribute__((target("avx512f"))) int batched_paths_avx512(const uint64_t root_p, const uint64_t root_other, const int number_path, random_generator& rng) {
+	return batched_paths<N, lanes_avx512, 8>(root_p, root_other, number_path, rng);
+}
+#endif
+
+template <int N> inline bool score_paths_batched(const bitboard<N>& root, const piece p, const int number_path, random_generator& rng, int &count_win, std::true_type) {
+	// play the random paths of score_move() by batches, if the processor allows it
+#ifdef OTHELLO_SIMD
+	const piece other = (p == piece::X) ? piece::O : piece::X;
+	if (SIMD_PLAYOUTS and SIMD == simd_kind::AVX512) {
+		count_win = batched_paths_avx512<N>(root.get_pieces(p)._word[0], root.get_pieces(other)._word[0], number_path, rng);
+		return true;
+	} else if (SIMD_PLAYOUTS and SIMD == simd_kind::AVX2) {
+		count_win = batched_paths_avx2<N>(root.get_pieces(p)._word[0], root.get_pieces(other)._word[0], number_path, rng);
+		return true;
+	}
+#endif
+	return false;
+}
+
+template <int N> inline bool score_paths_batched(const bitboard<N>&, const piece, const int, random_generator&, int&, std::false_type) {
+	// boards of more than one word
+	return false;
+}
+
+//----------------------------------------------------------------------------
+// Transposition table
+
+transposition_table TRANSPOSITION_TABLE;
+
+//----------------------------------------------------------------------------
+// Opening book
+
+std::string BOOK_FILE = "";
+opening_book BOOK;
+
+template <int N>
+uint64_t game_canonical_key(const othello_game& othello, const piece turn, int *symmetries) {
+	const bitboard<N> board(othello);
+	return canonical_key(board.get_pieces(piece::X), board.get_pieces(piece::O), turn == piece::O, symmetries);
+}
+
+uint64_t book_key(const othello_game& othello, const piece turn, int *symmetries) {
+	switch (BOARD_SIZE) {
+		case 4: return game_canonical_key<4>(othello, turn, symmetries);
+		case 6: return game_canonical_key<6>(othello, turn, symmetries);
+		case 8: return game_canonical_key<8>(othello, turn, symmetries);
+		case 10: return game_canonical_key<10>(othello, turn, symmetries);
+		case 12: return game_canonical_key<12>(othello, turn, symmetries);
+		case 14: return game_canonical_key<14>(othello, turn, symmetries);
+		default: return game_canonical_key<16>(othello, turn, symmetries);
+	}
+}
+
+int book_square(const int square, const int symmetries) {
+	// the smallest image of square by the symmetries mapping the position to its canonical form (the identity only if it is one of them)
+	int best = symmetric_square(square, __builtin_ctz(symmetries), BOARD_SIZE);
+	for (int s = 0; s < SYMMETRIES; s++) {
+		if ((symmetries >> s) & 1) {
+			best = std::min(best, symmetric_square(square, s, BOARD_SIZE));
+		}
+	}
+	return best;
+}
+
+int game_square(const int square, const int symmetries) {
+	// any of the symmetries gives an equivalent square: the first one is undone (no square: -1 kept)
+	if (square < 0) {
+		return square;
+	}
+	return symmetric_square(square, inverse_symmetry(__builtin_ctz(symmetries)), BOARD_SIZE);
+}
+
+uint64_t position_key(const othello_game& othello, const piece turn) {
+	uint64_t key = ZOBRIST._board_size[BOARD_SIZE] ^ ((turn == piece::O) ? ZOBRIST._turn : 0);
+	for (int i = 0; i < BOARD_SIZE; i++) {
+		for (int j = 0; j < BOARD_SIZE; j++) {
+			const piece p = othello.get_othelloboard_piece(i, j);
+			if (p != piece::EMPTY) {
+				key ^= ZOBRIST._piece[(p == piece::X) ? 0 : 1][i * BOARD_SIZE + j];
+			}
+		}
+	}
+	return key;
+}
+
+bool opening_book::open(const std::string& file_name) {
+	close();
+#ifdef _WIN32
+	HANDLE file = CreateFileA(file_name.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	LARGE_INTEGER size;
+	if (not GetFileSizeEx(file, &size) or size.QuadPart < (LONGLONG) sizeof(book_header)) {
+		CloseHandle(file);
+		return false;
+	}
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	void *view = (mapping != nullptr) ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (view == nullptr) {
+		if (mapping != nullptr) {CloseHandle(mapping);}
+		CloseHandle(file);
+		return false;
+	}
+	_file = file;
+	_mapping = mapping;
+	_view = view;
+	_view_size = (size_t) size.QuadPart;
+#else
+	const int file = ::open(file_name.c_str(), O_RDONLY);
+	if (file < 0) {
+		return false;
+	}
+	struct stat status;
+	if (fstat(file, &status) != 0 or status.st_size < (off_t) sizeof(book_header)) {
+		::close(file);
+		return false;
+	}
+	void *view = mmap(nullptr, (size_t) status.st_size, PROT_READ, MAP_SHARED, file, 0);
+	::close(file); // the mapping keeps the file open
+	if (view == MAP_FAILED) {
+		return false;
+	}
+	_view = view;
+	_view_size = (size_t) status.st_size;
+#endif
+	// check the header: the entries must fill the rest of the file
+	const book_header *header = (const book_header *) _view;
+	if (not std::equal(BOOK_MAGIC, BOOK_MAGIC + 8, header->_magic) or header->_number_entry != (_view_size - sizeof(book_header)) / sizeof(book_entry)
+		or (_view_size - sizeof(book_header)) % sizeof(book_entry) != 0) {
+		close();
+		return false;
+	}
+	_entries = (const book_entry *) (header + 1);
+	_number_entry = (size_t) header->_number_entry;
+	_board_size = (int) header->_board_size;
+	return true;
+}
+
+void opening_book::close() {
+	if (_view != nullptr) {
+#ifdef _WIN32
+		UnmapViewOfFile(_view);
+		CloseHandle((HANDLE) _mapping);
+		CloseHandle((HANDLE) _file);
+#else
+		munmap(_view, _view_size);
+#endif
+	}
+	_entries = nullptr;
+	_number_entry = 0;
+	_board_size = 0;
+	_view = nullptr;
+	_view_size = 0;
+	_file = nullptr;
+	_mapping = nullptr;
+}
+
+std::tuple<const book_entry*, const book_entry*> opening_book::find(const uint64_t key) const {
+	// binary search of the sorted entries
+	const book_entry *first = std::lower_bound(begin(), end(), key, [] (const book_entry& entry, const uint64_t k) {return entry._key < k;});
+	const book_entry *last = first;
+	while (last != end() and last->_key == key) {
+		last++;
+	}
+	return std::make_tuple(first, last);
+}
+
+int opening_book::best_move(const uint64_t key, double &score) const {
+	// the move with the best score, the results of each move being counted from one win and one loss
+	// (so that a move played in a few games only does not look better than it is)
+	const std::tuple<const book_entry*, const book_entry*> entries = find(key);
+	int best_move = -1;
+	for (const book_entry *entry = std::get<0>(entries); entry != std::get<1>(entries); entry++) {
+		const double s = (entry->_points / 2. + 1.) / (entry->_games + 2.);
+		if (entry->_games >= (uint32_t) BOOK_MIN_GAMES and (best_move == -1 or s > score)) {
+			best_move = entry->_move;
+			score = s;
+		}
+	}
+	return best_move;
+}
+
+bool opening_book::write(const std::string& file_name, const int board_size, std::vector<book_entry> entries) {
+	std::sort(entries.begin(), entries.end(), [] (const book_entry& a, const book_entry& b) {
+		return (a._key < b._key) or (a._key == b._key and a._move < b._move);
+	});
+	std::vector<book_entry> merged;
+	for (const book_entry& entry : entries) {
+		if (not merged.empty() and merged.back()._key == entry._key and merged.back()._move == entry._move) {
+			merged.back()._games += entry._games;
+			merged.back()._points += entry._points;
+		} else {
+			merged.push_back(entry);
+			std::fill(merged.back()._reserved, merged.back()._reserved + 3, 0);
+		}
+	}
+	book_header header;
+	std::copy(BOOK_MAGIC, BOOK_MAGIC + 8, header._magic);
+	header._board_size = (uint32_t) board_size;
+	header._reserved = 0;
+	header._number_entry = merged.size();
+	std::ofstream file(file_name, std::ios::binary | std::ios::trunc);
+	file.write((const char *) &header, sizeof(header));
+	if (not merged.empty()) {
+		file.write((const char *) merged.data(), (std::streamsize) (merged.size() * sizeof(book_entry)));
+	}
+	return (bool) file;
+}
+
+//----------------------------------------------------------------------------
+// Monte Carlo tree search (UCT)
+// the tree is kept from one move to the next: the subtree of the position
+// reached after the computer's move and the player's reply is reused
+
+const double UCT_EXPLORATION = 0.7; // exploration constant of the UCT formula
+const int MCTS_MAX_NODES = 1 << 20; // maximum number of nodes of one tree
+const int MCTS_CLOCK_CHECK = 64; // number of iterations between two checks of the deadline
+const int MCTS_HASH_VISITS = 16; // the nodes are stored in the transposition table from this number of visits
+const int MCTS_PRIOR_VISITS = 32; // maximum number of visits of a prior found in the transposition table
+
+struct mcts_node {
+	int _first_child; // index of the first child (children are consecutive); -1 if not expanded
+	short _child_count;
+	short _move; // square played to reach this node; -1 for a pass
+	int _visits;
+	float _wins; // wins (1 per win, 0.5 per tie) of the player who played _move
+	uint64_t _key; // canonical key of the position of the node (see canonical_key()), shared in the transposition table
+};
+
+template <int N>
+class mcts_tree {
+public:
+	// constructor
+	mcts_tree() : _root_turn(piece::X), _root_symmetries(1) {}
+	// getters
+	inline int get_root_child_count() const {return _nodes.empty() ? 0 : _nodes[0]._child_count;}
+	inline const mcts_node& get_root_child(const int i) const {return _nodes[_nodes[0]._first_child + i];}
+	// helper functions
+	void set_root(const bitboard<N>& board, const piece turn) {
+		// set the root of the tree to board, with turn to play
+		// the subtree of board is kept if board is reached within 2 moves from the current root
+		if (not _nodes.empty()) {
+			if (_root_board == board and _root_turn == turn) {
+				return;
+			}
+			for (int i = 0; i < _nodes[0]._child_count; i++) {
+				const int child = _nodes[0]._first_child + i;
+				bitboard<N> board1 = _root_board;
+				play(board1, _nodes[child]._move, _root_turn);
+				if (board1 == board and other(_root_turn) == turn) {
+					reroot(child);
+					return;
+				}
+				for (int j = 0; j < _nodes[child]._child_count; j++) {
+					const int grandchild = _nodes[child]._first_child + j;
+					bitboard<N> board2 = board1;
+					play(board2, _nodes[grandchild]._move, other(_root_turn));
+					if (board2 == board and _root_turn == turn) {
+						reroot(grandchild);
+						return;
+					}
+				}
+			}
+		}
+		// new tree
+		_nodes.clear();
+		_nodes.reserve(1024);
+		_nodes.push_back(new_node(-1, board, turn));
+		_root_board = board;
+		_root_turn = turn;
+		_root_symmetries = position_symmetries(board.get_pieces(piece::X), board.get_pieces(piece::O));
+	}
+	int search(const search_limits& limits, const rollout_cutoff& cutoff) {
+		// run iterations of selection, expansion, random path and backpropagation, and return their number
+		// (the deadline of an anytime search, and the stop flag, are checked every MCTS_CLOCK_CHECK iterations)
+		random_generator& rng = RANDOM;
+		move_list<N> moves;
+		std::vector<int> path;
+		path.reserve(2 * N * N + 2);
+		// a search that reuses the subtree of the previous search counts the visits of its root toward the limit
+		const int number_path = limits._number_path - ((limits._reuse) ? _nodes[0]._visits : 0);
+		int i = 0;
+		for (; (limits._timed and limits._number_path == 0) or i < number_path; i++) {
+			if ((limits._timed or limits._stop != nullptr) and i % MCTS_CLOCK_CHECK == 0 and limits.expired()) {
+				break;
+			}
+			bitboard<N> board = _root_board;
+			piece turn = _root_turn;
+			int node = 0;
+			path.clear();
+			path.push_back(node);
+			// selection
+			while (_nodes[node]._first_child >= 0 and _nodes[node]._child_count > 0) {
+				node = select_child(node);
+				play(board, _nodes[node]._move, turn);
+				turn = other(turn);
+				path.push_back(node);
+			}
+			// expansion (of the nodes already visited once)
+			if (_nodes[node]._first_child < 0 and _nodes[node]._visits > 0 and _nodes.size() + N * N < (size_t) MCTS_MAX_NODES) {
+				expand(node, board, turn, moves);
+				if (_nodes[node]._child_count > 0) {
+					node = select_child(node);
+					play(board, _nodes[node]._move, turn);
+					turn = other(turn);
+					path.push_back(node);
+				}
+			}
+			// random path
+			const int margin_x = path_result(board, turn, moves, rng, cutoff);
+			const float win_x = (margin_x > 0) ? 1.f : ((margin_x < 0) ? 0.f : 0.5f);
+			// backpropagation; the root was played by the opponent of _root_turn
+			// the statistics of the nodes visited enough are shared with the other trees
+			piece mover = other(_root_turn);
+			for (size_t k = 0; k < path.size(); k++) {
+				mcts_node& n = _nodes[path[k]];
+				n._visits++;
+				n._wins += (mover == piece::X) ? win_x : 1.f - win_x;
+				mover = other(mover);
+				if (n._visits >= MCTS_HASH_VISITS) {
+					TRANSPOSITION_TABLE.store(n._key, tt_monte_carlo(n._visits, n._wins));
+				}
+			}
+		}
+		return i;
+	}
+private:
+	std::vector<mcts_node> _nodes; // the root is _nodes[0]
+	bitboard<N> _root_board;
+	piece _root_turn;
+	int _root_symmetries; // symmetries of the root position: its moves equivalent by one of them are expanded once
+	static inline piece other(const piece p) {return (p == piece::X) ? piece::O : piece::X;}
+	static inline mcts_node new_node(const int move, const bitboard<N>& board, const piece turn) {
+		// node reached by move, board with turn to play
+		mcts_node node = {-1, 0, (short) move, 0, 0.f, canonical_key(board.get_pieces(piece::X), board.get_pieces(piece::O), turn == piece::O)};
+		return node;
+	}
+	static inline void play(bitboard<N>& board, const int move, const piece turn) {
+		if (move >= 0) {
+			board.make_move(move, turn);
+		}
+	}
+	int select_child(const int node) const {
+		// return the child of node with the best UCT value (unvisited children first)
+		const double log_visits = std::log((double) _nodes[node]._visits);
+		int best_child = -1;
+		double best_value = -1.;
+		for (int i = 0; i < _nodes[node]._child_count; i++) {
+			const int child = _nodes[node]._first_child + i;
+			const mcts_node& c = _nodes[child];
+			if (c._visits == 0) {
+				return child;
+			}
+			const double value = c._wins / c._visits + UCT_EXPLORATION * std::sqrt(log_visits / c._visits);
+			if (value > best_value) {
+				best_value = value;
+				best_child = child;
+			}
+		}
+		return best_child;
+	}
+	void expand(const int node, const bitboard<N>& board, const piece turn, move_list<N>& moves) {
+		// create the children of node: one per valid move (at the root, one per class of equivalent moves), a pass, or none at the end of the game
+		moves.fill(board.valid_moves(turn));
+		_nodes[node]._first_child = (int) _nodes.size();
+		if (moves._size > 0) {
+			int child_count = 0;
+			for (int i = 0; i < moves._size; i++) {
+				if (node == 0 and not distinct_square(moves._square[i], _root_symmetries, N)) {
+					continue;
+				}
+				bitboard<N> b = board;
+				b.make_move(moves._square[i], turn);
+				mcts_node child = new_node(moves._square[i], b, other(turn));
+				// the statistics of the position (in any orientation) found by this or another tree, if any, are used as a prior
+				uint64_t data;
+				if (TRANSPOSITION_TABLE.probe(child._key, data) and (data & 3) == TT_MONTE_CARLO) {
+					const int visits = tt_visits(data);
+					if (visits > 0) {
+						child._visits = std::min(visits, MCTS_PRIOR_VISITS);
+						child._wins = tt_wins(data) * child._visits / visits;
+					}
+				}
+				_nodes.push_back(child);
+				child_count++;
+			}
+			_nodes[node]._child_count = (short) child_count;
+		} else if (not board.valid_moves(other(turn)).empty()) {
+			_nodes.push_back(new_node(-1, board, other(turn)));
+			_nodes[node]._child_count = 1;
+		}
+	}
+	void reroot(const int new_root) {
+		// keep only the subtree of new_root
+		bitboard<N> board = _root_board;
+		piece turn = _root_turn;
+		// find the path to new_root (child or grandchild of the root)
+		for (int i = 0; i < _nodes[0]._child_count; i++) {
+			const int child = _nodes[0]._first_child + i;
+			if (child == new_root) {
+				play(board, _nodes[child]._move, turn);
+				turn = other(turn);
+				break;
+			}
+			const int first = _nodes[child]._first_child;
+			if (first >= 0 and new_root >= first and new_root < first + _nodes[child]._child_count) {
+				play(board, _nodes[child]._move, turn);
+				play(board, _nodes[new_root]._move, other(turn));
+				break;
+			}
+		}
+		// copy the subtree, breadth first, so that children stay consecutive
+		std::vector<mcts_node> nodes;
+		nodes.reserve(_nodes.size());
+		nodes.push_back(_nodes[new_root]);
+		for (size_t n = 0; n < nodes.size(); n++) {
+			const int first = nodes[n]._first_child;
+			if (first >= 0) {
+				nodes[n]._first_child = (int) nodes.size();
+				for (int i = 0; i < nodes[n]._child_count; i++) {
+					nodes.push_back(_nodes[first + i]);
+				}
+			}
+		}
+		_nodes.swap(nodes);
+		_root_board = board;
+		_root_turn = turn;
+		_root_symmetries = position_symmetries(board.get_pieces(piece::X), board.get_pieces(piece::O));
+	}
+};
+
+//----------------------------------------------------------------------------
+// Endgame solver
+// exact negamax search with alpha-beta pruning, for the positions with few
+// empty squares; the score is the final disc margin of the player to move
+
+const int SOLVER_INFINITY = 1000;
+const int SOLVER_FASTEST_FIRST = 7; // fastest-first move ordering above this number of empty squares
+const int SOLVER_HASH_EMPTY = 6; // positions are stored in the transposition table from this number of empty squares
+
+template <int N>
+class endgame_solver {
+public:
+	// constructor
+	endgame_solver(const std::atomic<bool> *stop) : _nodes(0), _stop(stop) {}
+	// getters
+	inline long long get_nodes() const {return _nodes;}
+	inline bool stopped() const {return _stop != nullptr and _stop->load(std::memory_order_relaxed);}
+	// helper functions
+	int solve(const bitboard<N>& board, const piece p, int alpha, const int beta, const bool passed) {
+		// return the final disc margin for p (exact if it is within ]alpha, beta[; otherwise a bound)
+		// once the stop flag is set, every call returns at once: the margin is meaningless, and nothing is stored
+		if (stopped()) {
+			return 0;
+		}
+		_nodes++;
+		const square_set<N> moves = board.valid_moves(p);
+		if (moves.empty()) {
+			if (passed) {
+				// end of the game
+				return board.score_board(p) - board.score_board(other(p));
+			}
+			return -solve(board, other(p), -beta, -alpha, true);
+		}
+		// bounds and best move found by a previous search of this position
+		const int empty = board.get_empty().count();
+		const uint64_t key = board.get_hash(p);
+		int hash_move = -1;
+		int beta_search = beta;
+		uint64_t data;
+		if (empty >= SOLVER_HASH_EMPTY and TRANSPOSITION_TABLE.probe(key, data) and (data & 3) == TT_SOLVER) {
+			const int lower = tt_lower(data);
+			const int upper = tt_upper(data);
+			if (lower >= beta or lower == upper) {
+				return lower;
+			}
+			if (upper <= alpha) {
+				return upper;
+			}
+			alpha = std::max(alpha, lower);
+			beta_search = std::min(beta, upper);
+			hash_move = tt_move(data);
+		}
+		const int alpha_search = alpha;
+		int squares[N * N];
+		const int number_move = order_moves(board, p, moves, squares, hash_move);
+		int best = -SOLVER_INFINITY;
+		int best_move = -1;
+		for (int i = 0; i < number_move; i++) {
+			bitboard<N> b = board;
+			b.make_move(squares[i], p);
+			const int value = -solve(b, other(p), -beta_search, -alpha, false);
+			if (value > best) {
+				best = value;
+				best_move = squares[i];
+				if (value > alpha) {
+					alpha = value;
+					if (alpha >= beta_search) {
+						break;
+					}
+				}
+			}
+		}
+		if (empty >= SOLVER_HASH_EMPTY and not stopped()) {
+			// best is an upper bound if it is <= alpha_search, a lower bound if it is >= beta_search
+			const int lower = (best > alpha_search) ? best : -TT_BOUND;
+			const int upper = (best < beta_search) ? best : TT_BOUND;
+			TRANSPOSITION_TABLE.store(key, tt_solver(lower, upper, best_move, empty));
+		}
+		return best;
+	}
+	static int order_moves(const bitboard<N>& board, const piece p, const square_set<N>& moves, int *squares, const int hash_move = -1) {
+		// fill squares with moves, best first, and return their number:
+		// the best move of a previous search first (hash_move),
+		// then the moves in regions (quarters of the board) with an odd number of empty squares (parity),
+		// then, far from the end of the game, the moves leaving the fewest moves to the opponent (fastest-first)
+		move_list<N> list;
+		list.fill(moves);
+		const square_set<N> empty = board.get_empty();
+		square_set<N> odd;
+		odd.clear();
+		for (int q = 0; q < 4; q++) {
+			if ((empty & board_masks<N>::instance._quarter[q]).count() % 2 == 1) {
+				odd |= board_masks<N>::instance._quarter[q];
+			}
+		}
+		const bool fastest_first = empty.count() > SOLVER_FASTEST_FIRST;
+		int keys[N * N];
+		for (int i = 0; i < list._size; i++) {
+			const int square = list._square[i];
+			int key = odd.test(square) ? 0 : 1;
+			if (square == hash_move) {
+				key = -1;
+			} else if (fastest_first) {
+				bitboard<N> b = board;
+				b.make_move(square, p);
+				key += 2 * b.valid_moves(other(p)).count();
+			}
+			// insertion sort
+			int j = i;
+			while (j > 0 and keys[j - 1] > key) {
+				keys[j] = keys[j - 1];
+				squares[j] = squares[j - 1];
+				j--;
+			}
+			keys[j] = key;
+			squares[j] = square;
+		}
+		return list._size;
+	}
+private:
+	long long _nodes; // number of positions searched
+	const std::atomic<bool> *_stop; // stop flag of the search (nullptr: none)
+	static inline piece other(const piece p) {return (p == piece::X) ? piece::O : piece::X;}
+};
+
+//----------------------------------------------------------------------------
+// Perft
+// number of leaf nodes of the game tree to a given depth, to check the move
+// generators and measure their speed: a pass is one ply, and a position
+// where the game is over is a leaf node, whatever the depth left
+
+long long game_perft(const othello_game& othello, const piece p, const int depth) {
+	// perft with the rules of othello_game (valid_moves() and execute_move())
+	if (depth == 0) {
+		return 1;
+	}
+	const piece other = (p == piece::X) ? piece::O : piece::X;
+	const std::vector<std::tuple<int, int>> moves = othello.valid_moves(p);
+	if (moves.empty()) {
+		if (othello.valid_moves(other).empty()) {
+			return 1;
+		}
+		return game_perft(othello, other, depth - 1);
+	}
+	long long count = 0;
+	for (std::tuple<int, int> move : moves) {
+		othello_game child = othello;
+		child.make_move(std::get<0>(move), std::get<1>(move), p);
+		count += game_perft(child, other, depth - 1);
+	}
+	return count;
+}
+
+template <int N>
+long long bitboard_perft(const bitboard<N>& board, const piece p, const int depth) {
+	// perft with the bitboards; the moves of the last ply are counted, not played
+	if (depth == 0) {
+		return 1;
+	}
+	const piece other = (p == piece::X) ? piece::O : piece::X;
+	const square_set<N> moves = board.valid_moves(p);
+	if (moves.empty()) {
+		if (board.valid_moves(other).empty()) {
+			return 1;
+		}
+		return bitboard_perft(board, other, depth - 1);
+	}
+	if (depth == 1) {
+		return moves.count();
+	}
+	move_list<N> list;
+	list.fill(moves);
+	long long count = 0;
+	for (int i = 0; i < list._size; i++) {
+		bitboard<N> b = board;
+		b.make_move(list._square[i], p);
+		count += bitboard_perft(b, other, depth - 1);
+	}
+	return count;
+}
+
+template <int N>
+long long perft_split(const bitboard<N>& board, const piece p, const int ply, std::vector<std::tuple<bitboard<N>, piece>>& positions) {
+	// add the positions reached after ply plies to positions, and return the number of games over before
+	if (ply == 0) {
+		positions.push_back(std::make_tuple(board, p));
+		return 0;
+	}
+	const piece other = (p == piece::X) ? piece::O : piece::X;
+	const square_set<N> moves = board.valid_moves(p);
+	if (moves.empty()) {
+		if (board.valid_moves(other).empty()) {
+			return 1;
+		}
+		return perft_split(board, other, ply - 1, positions);
+	}
+	move_list<N> list;
+	list.fill(moves);
+	long long count = 0;
+	for (int i = 0; i < list._size; i++) {
+		bitboard<N> b = board;
+		b.make_move(list._square[i], p);
+		count += perft_split(b, other, ply - 1, positions);
+	}
+	return count;
+}
+
+const int PERFT_SPLIT_PLY = 3; // the parallel perft runs one task per position at this ply
+
+//----------------------------------------------------------------------------
+// Engine
+
+template <int N>
+class othello_engine_size : public othello_engine {
+public:
+	int score_move(const othello_game& game, const int play_row, const int play_col, const piece p, const int number_path, const rollout_cutoff& cutoff) const {
+		// the random paths below make no heap allocation: the root position, the board
+		// (reset in place from the root before each path) and the fixed capacity list
+		// of moves are allocated once on the stack of the calling thread
+		const piece other = (p == piece::X) ? piece::O : piece::X;
+		int count_win = 0;
+		bitboard<N> root(game);
+		root.make_move(play_row * N + play_col, p);
+		bitboard<N> board = root;
+		move_list<N> moves;
+		random_generator& rng = RANDOM;
+#ifdef OTHELLO_DEBUG
+		const long long allocation_count = ALLOCATION_COUNT;
+#endif
+		if (cutoff.active()) {
+			// the batched paths are played to the end
+			for (int i = 0; i < number_path; i++) {
+				board = root;
+				const int margin_x = path_result(board, other, moves, rng, cutoff);
+				if ((p == piece::X) ? margin_x > 0 : margin_x < 0) {
+					count_win++;
+				}
+			}
+		} else if (not score_paths_batched(root, p, number_path, rng, count_win, std::integral_constant<bool, (square_set<N>::WORDS == 1)>())) {
+			for (int i = 0; i < number_path; i++) {
+				board = root;
+				random_path(board, other, moves, rng);
+				if (computer_win(board.score_board(other), board.score_board(p)) == 1) {
+					count_win++;
+				}
+			}
+		}
+#ifdef OTHELLO_DEBUG
+		assert(ALLOCATION_COUNT == allocation_count);
+#endif
+		return count_win;
+	}
+	int search_tree(const othello_game& game, const piece p, const int number_thread, const search_limits& limits, const rollout_cutoff& cutoff, double &score, long long &paths, std::vector<search_candidate>& candidates) {
+		// root parallelization: one tree per task, the statistics of the root moves are summed
+		const bitboard<N> root(game);
+		if ((int) _trees.size() != number_thread) {
+			_trees.clear();
+			_trees.resize(number_thread);
+		}
+		std::atomic<long long> iterations(0);
+		task_group group;
+		for (int i = 0; i < number_thread; i++) {
+			// it is critical to have independent random numbers for each tree
+			const random_generator stream = new_random_stream();
+			mcts_tree<N> *tree = &_trees[i];
+			POOL->submit(group, [tree, root, p, stream, limits, cutoff, &iterations] {
+				RANDOM = stream;
+				tree->set_root(root, p);
+				iterations += tree->search(limits, cutoff);
+			});
+		}
+		POOL->wait(group);
+		paths = iterations.load();
+		int visits[N * N] = {0};
+		double wins[N * N] = {0.};
+		for (int i = 0; i < number_thread; i++) {
+			for (int j = 0; j < _trees[i].get_root_child_count(); j++) {
+				const mcts_node& child = _trees[i].get_root_child(j);
+				if (child._move >= 0) {
+					visits[child._move] += child._visits;
+					wins[child._move] += child._wins;
+				}
+			}
+		}
+		int best_move = -1;
+		candidates.clear();
+		for (int square = 0; square < N * N; square++) {
+			if (visits[square] > 0 and (best_move == -1 or visits[square] > visits[best_move])) {
+				best_move = square;
+			}
+			if (visits[square] > 0) {
+				const search_candidate candidate = {square / N, square % N, visits[square], wins[square] / visits[square]};
+				candidates.push_back(candidate);
+			}
+		}
+		score = (best_move >= 0) ? wins[best_move] / visits[best_move] : 0.;
+		return best_move;
+	}
+	int solve_endgame(const othello_game& game, const piece p, int &margin, long long &nodes, const std::atomic<bool> *stop) const {
+		// parallel split at the root: the first (best ordered) move is solved alone, then the
+		// other moves are solved as tasks of POOL, with the best margin found so far as alpha
+		// (the margins of the moves whose search was stopped are dropped); of the moves equivalent
+		// by a symmetry of the position, only one is solved
+		const piece other = (p == piece::X) ? piece::O : piece::X;
+		const bitboard<N> root(game);
+		int squares[N * N];
+		const int symmetries = position_symmetries(root.get_pieces(piece::X), root.get_pieces(piece::O));
+		const int number_ordered = endgame_solver<N>::order_moves(root, p, root.valid_moves(p), squares);
+		int number_move = 0;
+		for (int i = 0; i < number_ordered; i++) {
+			if (distinct_square(squares[i], symmetries, N)) {
+				squares[number_move++] = squares[i];
+			}
+		}
+		if (number_move == 0) {
+			margin = 0;
+			nodes = 0;
+			return -1;
+		}
+		endgame_solver<N> solver(stop);
+		bitboard<N> b = root;
+		b.make_move(squares[0], p);
+		std::atomic<int> alpha(-solver.solve(b, other, -SOLVER_INFINITY, SOLVER_INFINITY, false));
+		std::atomic<int> best_move(squares[0]);
+		std::atomic<long long> task_nodes(solver.get_nodes());
+		std::mutex best_mutex;
+		task_group group;
+		for (int i = 1; i < number_move; i++) {
+			const int square = squares[i];
+			POOL->submit(group, [root, p, other, square, stop, &alpha, &best_move, &best_mutex, &task_nodes] {
+				endgame_solver<N> task_solver(stop);
+				bitboard<N> b = root;
+				b.make_move(square, p);
+				const int a = alpha.load();
+				const int value = -task_solver.solve(b, other, -SOLVER_INFINITY, -a, false);
+				task_nodes += task_solver.get_nodes();
+				if (value > a and not task_solver.stopped()) {
+					// exact margin, better than the margin known when the task started
+					std::lock_guard<std::mutex> lock(best_mutex);
+					if (value > alpha.load()) {
+						alpha.store(value);
+						best_move.store(square);
+					}
+				}
+			});
+		}
+		POOL->wait(group);
+		margin = alpha.load();
+		nodes = task_nodes.load();
+		return best_move.load();
+	}
+	long long perft(const othello_game& game, const piece p, const int depth, const bool parallel) const {
+		const bitboard<N> root(game);
+		if (not parallel or depth <= PERFT_SPLIT_PLY) {
+			return bitboard_perft(root, p, depth);
+		}
+		// the positions at PERFT_SPLIT_PLY are searched as tasks of POOL
+		std::vector<std::tuple<bitboard<N>, piece>> positions;
+		const long long count = perft_split(root, p, PERFT_SPLIT_PLY, positions);
+		std::vector<long long> counts(positions.size(), 0);
+		task_group group;
+		for (size_t i = 0; i < positions.size(); i++) {
+			POOL->submit(group, [&positions, &counts, i, depth] {
+				counts[i] = bitboard_perft(std::get<0>(positions[i]), std::get<1>(positions[i]), depth - PERFT_SPLIT_PLY);
+			});
+		}
+		POOL->wait(group);
+		return std::accumulate(counts.begin(), counts.end(), count);
+	}
+private:
+	std::vector<mcts_tree<N>> _trees; // one tree per thread
+};
+
+std::unique_ptr<othello_engine> create_engine(const int board_size) {
+	// return a new engine for board_size (even number, from 4 to MAX_BOARD_SIZE)
+	switch (board_size) {
+		case 4: return std::unique_ptr<othello_engine>(new othello_engine_size<4>);
+		case 6: return std::unique_ptr<othello_engine>(new othello_engine_size<6>);
+		case 8: return std::unique_ptr<othello_engine>(new othello_engine_size<8>);
+		case 10: return std::unique_ptr<othello_engine>(new othello_engine_size<10>);
+		case 12: return std::unique_ptr<othello_engine>(new othello_engine_size<12>);
+		case 14: return std::unique_ptr<othello_engine>(new othello_engine_size<14>);
+		default: return std::unique_ptr<othello_engine>(new othello_engine_size<16>);
+	}
+}
+
+
+othello_engine *ENGINE = nullptr;
+
+void init_engine() {
+	// set the random streams, the engine, the transposition table, the evaluator, the book and the telemetry from the parameters
+	// (the caller sets POOL, whose threads live as long as the caller needs them)
+	if (MASTER_SEED == 0) {MASTER_SEED = (uint64_t) std::chrono::system_clock::now().time_since_epoch().count();}
+	RANDOM_STREAMS = random_generator(MASTER_SEED);
+	static std::unique_ptr<othello_engine> engine;
+	engine = create_engine(BOARD_SIZE);
+	ENGINE = engine.get();
+	if (HASH_SIZE > 0) {TRANSPOSITION_TABLE.resize(HASH_SIZE);}
+	if (not EVAL_FILE.empty() and EVALUATOR.load(EVAL_FILE) and EVALUATOR.board_size() != BOARD_SIZE) {EVALUATOR = pattern_evaluator();}
+	if (not BOOK_FILE.empty() and BOOK.open(BOOK_FILE) and BOOK.board_size() != BOARD_SIZE) {BOOK.close();}
+	if (not TELEMETRY_FILE.empty()) {TELEMETRY.open(TELEMETRY_FILE);}
+}
+
+//----------------------------------------------------------------------------
+// Search
+
+const int MONTE_CARLO_BATCH = 256; // number of paths per task of POOL
+const int ROOT_ROUNDS = 8; // rounds of a flat search with a fixed number of paths and pruning
+const int TREE_REPORT_SLICE = 250; // milliseconds of tree search between two reports
+
+void submit_batch(const othello_engine& engine, const othello_game& othello, const int play_row, const int play_col, const piece p, const int number_path, const rollout_cutoff& cutoff, task_group& group, int *count_win, const std::atomic<bool> *stop = nullptr) {
+	// queue one batch of number_path Monte Carlo paths assessing move (play_row, play_col) for p
+	// count_win receives the number of paths won by p, or -1 if stop was set before the batch started
+	// it is critical to have independent random numbers for each batch
+	const random_generator stream = new_random_stream();
+	const othello_engine *e = &engine;
+	POOL->submit(group, [e, othello, play_row, play_col, p, number_path, cutoff, stream, count_win, stop] {
+		if (stop != nullptr and stop->load(std::memory_order_relaxed)) {
+			*count_win = -1;
+			return;
+		}
+		RANDOM = stream;
+		*count_win = e->score_move(othello, play_row, play_col, p, number_path, cutoff);
+	});
+}
+
+void submit_move(const othello_engine& engine, const search_parameters& parameters, const othello_game& othello, const int play_row, const int play_col, const piece p, task_group& group, std::vector<int>& count_win) {
+	// queue the Monte Carlo paths assessing move (play_row, play_col) for p, by batches
+	// count_win receives the number of paths won by p for each batch
+	const int number_batch = (parameters._number_path + MONTE_CARLO_BATCH - 1) / MONTE_CARLO_BATCH;
+	count_win.assign(number_batch, 0);
+	for (int i = 0; i < number_batch; i++) {
+		const int number_path = std::min(MONTE_CARLO_BATCH, parameters._number_path - i * MONTE_CARLO_BATCH);
+		submit_batch(engine, othello, play_row, play_col, p, number_path, parameters._cutoff, group, &count_win[i]);
+	}
+}
+
+int assess_move(task_group& group, const std::vector<int>& count_win) {
+	// wait for the batches queued by submit_move(), and return the number of paths won
+	POOL->wait(group);
+	return std::accumulate(count_win.begin(), count_win.end(), 0);
+}
+
+void prune_moves(const std::vector<int>& count_win, const std::vector<int>& count_path, std::vector<char>& alive) {
+	// drop the moves whose upper confidence bound is below the lower confidence bound of the best move
+	std::vector<search_candidate> candidates(alive.size());
+	int best = -1;
+	for (size_t i = 0; i < alive.size(); i++) {
+		candidates[i]._paths = count_path[i];
+		candidates[i]._score = (count_path[i] > 0) ? 1. * count_win[i] / count_path[i] : 0.;
+		if (alive[i] and (best == -1 or candidates[i]._score > candidates[best]._score)) {
+			best = (int) i;
+		}
+	}
+	const double lower = candidates[best]._score - candidates[best].confidence();
+	for (size_t i = 0; i < alive.size(); i++) {
+		if (alive[i] and candidates[i]._score + candidates[i].confidence() < lower) {
+			alive[i] = false;
+		}
+	}
+}
+
+void assess_moves_rounds(const othello_engine& engine, const search_parameters& parameters, const othello_game& othello, const piece p, const std::vector<std::tuple<int, int>> &moves, const bool timed, const search_clock::time_point deadline, const long long budget, const ponder_reply *pondered, const search_progress& progress, search_result& result) {
+	// flat Monte Carlo by rounds of batches for the moves still in the race, until budget paths in all, the pondered ones included (0: no budget)
+	// or, if timed, until the deadline; with _pruning, the moves clearly worse than the best one leave the race after
+	// each round, and the next rounds share the paths between the others (the best move is only chosen among them)
+	// the paths start from the pondered ones, if any; the best move so far is reported to progress after each round,
+	// and the statistics of the moves to _report once they all have paths; once _stop is set, the batches not started are dropped
+	const int number_move = moves.size();
+	std::vector<int> count_win = (pondered != nullptr) ? pondered->_count_win : std::vector<int>(number_move, 0);
+	std::vector<int> count_path(number_move, (pondered != nullptr) ? pondered->_count_path : 0);
+	std::vector<char> alive(number_move, true);
+	std::vector<int> batch_move; // move, paths and wins of each batch of a round
+	std::vector<int> batch_path;
+	std::vector<int> batch_win;
+	// a fixed budget is spent in about ROOT_ROUNDS rounds; a round feeds all the threads
+	const long long round_path = timed ? 0 : budget / ROOT_ROUNDS;
+	long long spent = (long long) count_path[0] * number_move; // paths of all the moves, the pondered ones included
+	bool assessed = count_path[0] > 0; // every move has paths (after the first round, or after pondering)
+	search_clock::duration round = search_clock::duration::zero();
+	while (true) {
+		int number_alive = 0;
+		const bool stopped = parameters._stop != nullptr and parameters._stop->load();
+		if (assessed or stopped) {
+			if (parameters._pruning and assessed) {
+				prune_moves(count_win, count_path, alive);
+			}
+			result._row = -1;
+			result._candidates.clear();
+			for (int i = 0; i < number_move; i++) {
+				if (count_path[i] == 0) {
+					continue;
+				}
+				const double s = 1. * count_win[i] / count_path[i];
+				if (assessed) {
+					// the statistics of the moves of a first round stopped midway are not compared
+					const search_candidate candidate = {std::get<0>(moves[i]), std::get<1>(moves[i]), count_path[i], s};
+					result._candidates.push_back(candidate);
+				}
+				if (alive[i] and (s > result._score or result._row == -1)) {
+					result._score = s;
+					result._row = std::get<0>(moves[i]);
+					result._col = std::get<1>(moves[i]);
+				}
+			}
+			if (progress and result._row >= 0) {progress(result._row, result._col);}
+			if (parameters._report and assessed and result._row >= 0) {parameters._report(result);}
+		}
+		for (int i = 0; i < number_move; i++) {
+			number_alive += alive[i] ? 1 : 0;
+		}
+		// paths of each move in the race for this round: enough batches for all the threads, and the budget not exceeded
+		const int copies = (parameters._number_thread + number_alive - 1) / number_alive;
+		long long move_path = std::max((long long) copies * MONTE_CARLO_BATCH, round_path / number_alive);
+		if (budget > 0) {
+			move_path = std::min(move_path, (budget - spent) / number_alive);
+		}
+		// stop if the budget is spent, if only one move is left in the race, or if the next round is expected to end after the deadline
+		const search_clock::time_point start = search_clock::now();
+		if (stopped or (assessed and (move_path <= 0 or (parameters._pruning and number_alive == 1) or (timed and start + round > deadline)))) {
+			break;
+		}
+		task_group group;
+		batch_move.clear();
+		batch_path.clear();
+		for (int i = 0; i < number_move; i++) {
+			for (long long path = 0; alive[i] and path < move_path; path += MONTE_CARLO_BATCH) {
+				batch_move.push_back(i);
+				batch_path.push_back((int) std::min((long long) MONTE_CARLO_BATCH, move_path - path));
+			}
+		}
+		batch_win.assign(batch_move.size(), 0);
+		for (size_t b = 0; b < batch_move.size(); b++) {
+			const int i = batch_move[b];
+			submit_batch(engine, othello, std::get<0>(moves[i]), std::get<1>(moves[i]), p, batch_path[b], parameters._cutoff, group, &batch_win[b], parameters._stop);
+		}
+		POOL->wait(group);
+		bool complete = true; // no batch of the round was dropped
+		for (size_t b = 0; b < batch_move.size(); b++) {
+			if (batch_win[b] >= 0) {
+				count_win[batch_move[b]] += batch_win[b];
+				count_path[batch_move[b]] += batch_path[b];
+				spent += batch_path[b];
+				result._paths += batch_path[b];
+			} else {
+				complete = false;
+			}
+		}
+		assessed = assessed or complete;
+		round = search_clock::now() - start;
+	}
+}
+
+int computer_move_time(const othello_game& othello) {
+	// return the time allowed for the computer's move in milliseconds (0: no time control)
+	if (MOVE_TIME > 0) {
+		return MOVE_TIME;
+	}
+	if (GAME_TIME > 0) {
+		// share the time left equally between the computer's remaining moves
+		const int empty = othello.score_board(piece::EMPTY);
+		const int moves_left = (empty + 1) / 2;
+		return std::max(1LL, GAME_TIME_LEFT / std::max(1, moves_left));
+	}
+	return 0;
+}
+
+search_result search_position(othello_engine& engine, const search_parameters& parameters, const othello_game& othello, const piece p, const int move_time, const search_progress& progress) {
+	// search_move(), without the telemetry
+	// the moves equivalent by a symmetry of the position are searched once, the paths of all the valid moves
+	// (_number_path each) being shared between them
+	search_result result = {-1, -1, -0., false, 0, 0, 0, false, false, {}};
+	const std::vector<std::tuple<int, int>> moves = distinct_moves(othello, p);
+	const long long budget = (long long) parameters._number_path * othello.valid_moves(p).size();
+	if (moves.empty()) {
+		return result;
+	}
+	if (parameters._book != nullptr and parameters._book->loaded()) {
+		int symmetries;
+		const uint64_t key = book_key(othello, p, &symmetries);
+		int book_move = parameters._book->best_move(key, result._score);
+		if (book_move >= 0) {
+			book_move = game_square(book_move, symmetries);
+		}
+		const std::vector<std::tuple<int, int>> valid = othello.valid_moves(p);
+		if (book_move >= 0 and std::find(valid.begin(), valid.end(), std::make_tuple(book_move / BOARD_SIZE, book_move % BOARD_SIZE)) != valid.end()) {
+			result._row = book_move / BOARD_SIZE;
+			result._col = book_move % BOARD_SIZE;
+			result._book = true;
+			return result;
+		}
+		result._score = -0.;
+	}
+	// ponder hit: the position was searched while the player was thinking
+	const ponder_reply *pondered = (parameters._ponder != nullptr) ? parameters._ponder->find(othello, p) : nullptr;
+	const search_clock::time_point deadline = search_clock::now() + std::chrono::milliseconds(move_time);
+	if (othello.score_board(piece::EMPTY) <= parameters._endgame_empty) {
+		// exact endgame: the score is 1 for a proven win, 0.5 for a draw, 0 for a loss
+		// (a stopped solver gives its best move so far, unproven)
+		if (progress) {progress(-1, -1);}
+		const int best_move = engine.solve_endgame(othello, p, result._margin, result._nodes, parameters._stop);
+		result._row = best_move / BOARD_SIZE;
+		result._col = best_move % BOARD_SIZE;
+		result._solved = parameters._stop == nullptr or not parameters._stop->load();
+		if (not result._solved) {
+			result._margin = 0;
+		}
+		result._score = (result._margin > 0) ? 1. : ((result._margin == 0) ? 0.5 : 0.);
+		if (parameters._report and result._solved) {parameters._report(result);}
+	} else if (parameters._ai_mode == 'T') {
+		// Monte Carlo tree search, with the same total number of paths as the flat Monte Carlo (or until the deadline)
+		if (progress) {progress(-1, -1);}
+		search_limits limits = (move_time > 0) ? search_limits(deadline) : search_limits((int) (budget / parameters._number_thread));
+		limits._stop = parameters._stop;
+		if (pondered != nullptr) {
+			// the pondered subtree counts toward the limit; an anytime search also stops
+			// once its trees have as many paths as the pondering runs in move_time
+			limits._reuse = true;
+			if (move_time > 0) {
+				limits._number_path = (int) std::min(1e9, std::max(1., parameters._ponder->paths_per_ms() * move_time / parameters._number_thread));
+			}
+		}
+		int best_move;
+		if (not parameters._report) {
+			best_move = engine.search_tree(othello, p, parameters._number_thread, limits, parameters._cutoff, result._score, result._paths, result._candidates);
+		} else {
+			// slices of at most TREE_REPORT_SLICE ms, reported one by one: the trees are kept from a slice to the next,
+			// and a search without reuse runs the paths per tree left by the previous slices
+			const int number_path = limits._number_path;
+			long long paths = 0;
+			while (true) {
+				search_limits slice = limits;
+				slice._timed = true;
+				slice._deadline = search_clock::now() + std::chrono::milliseconds(TREE_REPORT_SLICE);
+				if (move_time > 0) {
+					slice._deadline = std::min(slice._deadline, deadline);
+				}
+				if (not limits._reuse and number_path > 0) {
+					slice._number_path = number_path - (int) (result._paths / parameters._number_thread);
+				}
+				best_move = engine.search_tree(othello, p, parameters._number_thread, slice, parameters._cutoff, result._score, paths, result._candidates);
+				result._paths += paths;
+				result._row = best_move / BOARD_SIZE;
+				result._col = best_move % BOARD_SIZE;
+				if (best_move >= 0) {parameters._report(result);}
+				if (paths == 0 or limits.expired() or (not limits._reuse and number_path > 0 and result._paths / parameters._number_thread >= number_path)) {
+					break;
+				}
+			}
+		}
+		result._ponder_hit = (pondered != nullptr);
+		result._row = best_move / BOARD_SIZE;
+		result._col = best_move % BOARD_SIZE;
+	} else if (move_time > 0) {
+		// after a ponder hit, the search also stops once it has as many paths as the pondering runs in move_time
+		const long long target_path = (pondered != nullptr) ? (long long) std::min(1e12, std::max(1., parameters._ponder->paths_per_ms() * move_time)) : 0;
+		assess_moves_rounds(engine, parameters, othello, p, moves, true, deadline, target_path, pondered, progress, result);
+		result._ponder_hit = (pondered != nullptr);
+	} else if (parameters._pruning or parameters._stop != nullptr or parameters._report) {
+		// the same number of paths as below, by rounds (shared between the moves still in the race, with pruning)
+		// (after a ponder hit, the pondered paths count toward them)
+		assess_moves_rounds(engine, parameters, othello, p, moves, false, deadline, budget, pondered, progress, result);
+		result._ponder_hit = (pondered != nullptr);
+	} else {
+		// the batches of all the moves are queued at once; the moves are reported as their assessment completes
+		// (after a ponder hit, only the paths missing to the pondered ones are run)
+		search_parameters left = parameters;
+		left._number_path = (int) (budget / moves.size());
+		if (pondered != nullptr) {
+			left._number_path = std::max(0, left._number_path - pondered->_count_path);
+		}
+		std::vector<task_group> groups(moves.size());
+		std::vector<std::vector<int>> count_win(moves.size());
+		for (size_t i = 0; i < moves.size(); i++) {
+			submit_move(engine, left, othello, std::get<0>(moves[i]), std::get<1>(moves[i]), p, groups[i], count_win[i]);
+		}
+		for (size_t i = 0; i < moves.size(); i++) {
+			const int row = std::get<0>(moves[i]);
+			const int col = std::get<1>(moves[i]);
+			if (progress) {progress(row, col);}
+			int wins = assess_move(groups[i], count_win[i]);
+			int paths = left._number_path;
+			if (pondered != nullptr) {
+				wins += pondered->_count_win[i];
+				paths += pondered->_count_path;
+			}
+			const double s = 1. * wins / paths;
+			const search_candidate candidate = {row, col, paths, s};
+			result._candidates.push_back(candidate);
+			if (s > result._score or result._row == -1 or result._col == -1) {
+				result._score = s;
+				result._row = row;
+				result._col = col;
+			}
+		}
+		result._paths = (long long) left._number_path * moves.size();
+		result._ponder_hit = (pondered != nullptr);
+	}
+	if (result._row < 0) {
+		// stopped before any move was assessed
+		result._row = std::get<0>(moves[0]);
+		result._col = std::get<1>(moves[0]);
+		result._score = 0.5;
+	}
+	return result;
+}
+
+search_result search_move(othello_engine& engine, const search_parameters& parameters, const othello_game& othello, const piece p, const int move_time, const search_progress& progress) {
+	// return the best move for p: exact endgame, or else tree search (_ai_mode 'T') or flat Monte Carlo,
+	// with _number_path paths per move, or else (move_time > 0) until move_time milliseconds;
+	// the move of the opening book, if the position is in _book
+	// a line of telemetry is written to _telemetry, if active
+	if (parameters._telemetry == nullptr or not parameters._telemetry->active()) {
+		return search_position(engine, parameters, othello, p, move_time, progress);
+	}
+	std::vector<long long> busy(POOL->get_number_thread());
+	for (size_t w = 0; w < busy.size(); w++) {
+		busy[w] = POOL->get_busy((int) w);
+	}
+	const telemetry_counters counters = telemetry_totals();
+	const search_clock::time_point start = search_clock::now();
+	const search_result result = search_position(engine, parameters, othello, p, move_time, progress);
+	const double elapsed = std::chrono::duration<double, std::milli>(search_clock::now() - start).count();
+	const telemetry_counters counters_end = telemetry_totals();
+	std::ostringstream line;
+	line << std::fixed << std::setprecision(3);
+	line << "{\"board_size\":" << BOARD_SIZE << ",\"position\":\"" << othello.get_position(p) << "\",\"empty\":" << othello.score_board(piece::EMPTY);
+	line << ",\"ai_mode\":\"" << parameters._ai_mode << "\",\"threads\":" << parameters._number_thread << ",\"move_time\":" << move_time;
+	const char *kind = (result._book) ? "book" : ((result._solved) ? "solver" : ((parameters._ai_mode == 'T') ? "tree" : "flat"));
+	line << ",\"kind\":\"" << ((result._row < 0) ? "pass" : kind) << "\",\"ponder_hit\":" << ((result._ponder_hit) ? "true" : "false");
+	line << ",\"move\":\"" << move_name(result._row, result._col) << "\",\"score\":" << std::setprecision(5) << result._score;
+	if (result._solved) {
+		line << ",\"margin\":" << result._margin;
+	}
+	line << ",\"paths\":" << result._paths << ",\"nodes\":" << result._nodes << std::setprecision(3) << ",\"elapsed_ms\":" << elapsed;
+	line << ",\"paths_per_s\":" << std::setprecision(0) << ((elapsed > 0.) ? 1000. * result._paths / elapsed : 0.);
+	line << ",\"candidates\":[";
+	for (size_t i = 0; i < result._candidates.size(); i++) {
+		const search_candidate& c = result._candidates[i];
+		line << ((i > 0) ? "," : "") << "{\"move\":\"" << move_name(c._row, c._col) << "\",\"paths\":" << c._paths;
+		line << std::setprecision(5) << ",\"score\":" << c._score << ",\"confidence\":" << c.confidence() << "}";
+	}
+	line << "],\"workers\":[" << std::setprecision(3);
+	for (size_t w = 0; w < busy.size(); w++) {
+		const double busy_ms = (POOL->get_busy((int) w) - busy[w]) / 1e6;
+		line << ((w > 0) ? "," : "") << "{\"busy_ms\":" << busy_ms << ",\"idle_ms\":" << std::max(0., elapsed - busy_ms) << "}";
+	}
+	line << "]";
+#ifdef OTHELLO_TELEMETRY
+	line << ",\"counters\":{";
+	for (int c = 0; c < TELEMETRY_COUNTERS; c++) {
+		line << ((c > 0) ? "," : "") << "\"" << TELEMETRY_COUNTER_NAME[c] << "\":" << counters_end._count[c] - counters._count[c];
+	}
+	line << "}";
+#else
+	(void) counters;
+	(void) counters_end;
+#endif
+	line << "}";
+	parameters._telemetry->write(line.str());
+	return result;
+}
+
+search_result search_move(const othello_game& othello, const piece p, const int move_time, const search_progress& progress) {
+	// search with ENGINE and the parameters of the command line
+	return search_move(*ENGINE, search_parameters(), othello, p, move_time, progress);
+}
+
+//----------------------------------------------------------------------------
+// Telemetry
+
+telemetry_stream TELEMETRY;
+
+bool telemetry_stream::open(const std::string& file_name) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (_file.is_open()) {
+		_file.close();
+	}
+	_file.open(file_name, std::ios::app);
+	return _file.is_open();
+}
+
+void telemetry_stream::close() {
+	std::lock_guard<std::mutex> lock(_mutex);
+	_file.close();
+}
+
+void telemetry_stream::write(const std::string& line) {
+	// one line at a time, flushed so that a dashboard can follow the file
+	std::lock_guard<std::mutex> lock(_mutex);
+	_file << line << std::endl;
+}
+
+//----------------------------------------------------------------------------
+// Pondering
+
+const int PONDER_SLICE = 20; // milliseconds of search between two checks of stop() (and two pauses)
+const int PONDER_BATCH = 64; // number of paths per task of POOL in a round of the flat Monte Carlo
+const int PONDER_REPLIES = 4; // number of the player's most likely replies pondered by the flat Monte Carlo
+
+ponder_search PONDER;
+
+void ponder_search::start(othello_engine& engine, const search_parameters& parameters, const othello_game& othello, const piece p, const int cpu) {
+	// list the player's replies, and start the thread unless the computer's next move is solved exactly
+	stop();
+	const piece other = (p == piece::X) ? piece::O : piece::X;
+	_engine = &engine;
+	_parameters = parameters;
+	_parameters._ponder = nullptr;
+	_parameters._telemetry = nullptr;
+	_parameters._stop = nullptr;
+	_parameters._report = nullptr;
+	_othello = othello;
+	_turn = p;
+	_cpu = std::min(100, cpu);
+	_stop = false;
+	_paths = 0;
+	_busy = 0.;
+	_replies.clear();
+	bool computer_moves = false;
+	for (const std::tuple<int, int>& move : othello.valid_moves(p)) {
+		ponder_reply reply;
+		reply._othello = othello;
+		reply._othello.make_move(std::get<0>(move), std::get<1>(move), p);
+		reply._key = position_key(reply._othello, other);
+		reply._moves = distinct_moves(reply._othello, other);
+		reply._count_win.assign(reply._moves.size(), 0);
+		reply._count_path = 0;
+		computer_moves = computer_moves or not reply._moves.empty();
+		_replies.push_back(reply);
+	}
+	if (_cpu > 0 and computer_moves and othello.score_board(piece::EMPTY) - 1 > _parameters._endgame_empty) {
+		_thread = std::thread(&ponder_search::run, this);
+	}
+}
+
+void ponder_search::start(const othello_game& othello, const piece p) {
+	start(*ENGINE, search_parameters(), othello, p, PONDER_CPU);
+}
+
+void ponder_search::stop() {
+	if (not _thread.joinable()) {
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stop = true;
+	}
+	_wake.notify_all();
+	_thread.join();
+}
+
+const ponder_reply *ponder_search::find(const othello_game& othello, const piece p) const {
+	if (_paths == 0 or p == _turn) {
+		return nullptr;
+	}
+	const uint64_t key = position_key(othello, p);
+	for (const ponder_reply& reply : _replies) {
+		if (reply._key == key) {
+			return &reply;
+		}
+	}
+	return nullptr;
+}
+
+void ponder_search::run() {
+	// search by slices; after a slice, pause (100 - _cpu) / _cpu times as long as the slice took
+	while (true) {
+		const search_clock::time_point start = search_clock::now();
+		if (_parameters._ai_mode == 'T') {
+			double score;
+			long long paths;
+			std::vector<search_candidate> candidates;
+			_engine->search_tree(_othello, _turn, _parameters._number_thread, search_limits(start + std::chrono::milliseconds(PONDER_SLICE)), _parameters._cutoff, score, paths, candidates);
+			_paths += paths;
+		} else {
+			_paths += ponder_flat();
+		}
+		const double busy = std::chrono::duration<double, std::milli>(search_clock::now() - start).count();
+		_busy += busy;
+		std::unique_lock<std::mutex> lock(_mutex);
+		const std::chrono::microseconds pause((long long) (1000. * busy * (100 - _cpu) / _cpu));
+		if (_wake.wait_for(lock, pause, [this] {return _stop;})) {
+			break;
+		}
+	}
+}
+
+long long ponder_search::ponder_flat() {
+	// one round of batches for the computer's moves after the least pondered of the PONDER_REPLIES most likely replies
+	// (a reply is the more likely as the best of the computer's moves after it is bad; the replies not pondered yet come first)
+	const piece other = (_turn == piece::X) ? piece::O : piece::X;
+	std::vector<std::tuple<double, int>> likely;
+	for (size_t r = 0; r < _replies.size(); r++) {
+		const ponder_reply& reply = _replies[r];
+		if (not reply._moves.empty()) {
+			const int best_win = *std::max_element(reply._count_win.begin(), reply._count_win.end());
+			likely.push_back(std::make_tuple((reply._count_path > 0) ? 1. * best_win / reply._count_path : -1., (int) r));
+		}
+	}
+	std::sort(likely.begin(), likely.end());
+	likely.resize(std::min((int) likely.size(), PONDER_REPLIES));
+	ponder_reply *reply = nullptr;
+	for (const std::tuple<double, int>& l : likely) {
+		ponder_reply& r = _replies[std::get<1>(l)];
+		if (reply == nullptr or r._count_path < reply->_count_path) {
+			reply = &r;
+		}
+	}
+	const int number_move = reply->_moves.size();
+	const int copies = (_parameters._number_thread + number_move - 1) / number_move;
+	std::vector<int> round_win(number_move * copies, 0);
+	task_group group;
+	for (int i = 0; i < number_move; i++) {
+		for (int c = 0; c < copies; c++) {
+			submit_batch(*_engine, reply->_othello, std::get<0>(reply->_moves[i]), std::get<1>(reply->_moves[i]), other, PONDER_BATCH, _parameters._cutoff, group, &round_win[i * copies + c]);
+		}
+	}
+	POOL->wait(group);
+	for (int i = 0; i < number_move; i++) {
+		reply->_count_win[i] += std::accumulate(round_win.begin() + i * copies, round_win.begin() + (i + 1) * copies, 0);
+	}
+	reply->_count_path += copies * PONDER_BATCH;
+	return (long long) number_move * copies * PONDER_BATCH;
+}
@@ -0,0 +1,1429 @@
+/*
+	Othello engine: rules, move generation, Monte Carlo searches and endgame solver
+
+	The engine makes no use of the console nor of any Windows specific function
+	(except the mapping of the opening book, with its POSIX equivalent elsewhere):
+	it is compiled with othello.cpp (the game, see the compile options there),
+	or with othello_bench.cpp (the benchmarks, on any platform).
+*/
+
+#ifndef OTHELLO_ENGINE_H
+#define OTHELLO_ENGINE_H
+
+#include <vector>
+#include <string>
+#include <tuple>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>     // unique_ptr
+#include <chrono>
+#include <algorithm>  // min(), max()
+#include <cstdint>    // uint64_t
+#include <type_traits> // integral_constant
+#include <cmath>      // exp()
+#include <fstream>    // ofstream (telemetry)
+
+enum class piece:char {EMPTY, X, O};
+
+const int MAX_BOARD_SIZE = 16;
+extern int BOARD_SIZE; // must be an even number, from 4 to MAX_BOARD_SIZE
+const int SQUARE_WORDS = MAX_BOARD_SIZE * MAX_BOARD_SIZE / 64; // words of a mask of the squares (row * BOARD_SIZE + col)
+extern int NUMBER_PROCESSOR; // number of processor to use for parallel threading
+extern int NUMBER_MONTE_CARLO_PATH; // AI: number of Monte Carlo path per move (for all threads)
+extern char AI_MODE; // 'F'lat Monte Carlo (same number of paths for each move), 'T'ree search (MCTS)
+extern int MOVE_TIME; // AI: time per move in milliseconds (0: NUMBER_MONTE_CARLO_PATH paths per move)
+extern int GAME_TIME; // AI: total time for a game in seconds (0: no game clock)
+extern long long GAME_TIME_LEFT; // AI: time left on the game clock in milliseconds
+extern int ENDGAME_EMPTY; // AI: number of empty squares from which the game is solved exactly (0: never)
+extern int HASH_SIZE; // AI: size of the transposition table in MB (0: no table)
+extern int ROLLOUT_DEPTH; // AI: number of moves after which a random path is cut off and scored by the evaluator (0: to the end)
+extern bool ROOT_PRUNING; // AI: flat Monte Carlo drops the moves clearly worse than the best one, and shares their paths between the others
+extern std::string EVAL_FILE; // AI: file of the weights of the evaluator ("": none, the random paths are played to the end)
+extern std::string BOOK_FILE; // AI: file of the opening book, played before any search ("": no book)
+extern int PONDER_CPU; // AI: share of the CPU in percent used to search on the player's time (0: no pondering)
+extern std::string TELEMETRY_FILE; // file to which a JSON line is appended per search ("": no telemetry)
+extern bool SIMD_PLAYOUTS; // AI: random paths of the flat Monte Carlo played by batches with AVX2/AVX-512, if available (boards up to 8 x 8)
+
+//----------------------------------------------------------------------------
+// Random numbers
+// xoshiro256** generator (http://prng.di.unimi.it/); each thread has its own
+// generator, which each task resets to its own stream: the streams are
+// derived from the master seed by jump-ahead (2^128 numbers apart), in the
+// order the tasks are queued, so that a fixed seed gives repeatable games
+
+class random_generator {
+public:
+	// constructor
+	random_generator(const uint64_t seed = 0) {
+		// fill the state with splitmix64
+		uint64_t x = seed;
+		for (int i = 0; i < 4; i++) {
+			uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+			_s[i] = z ^ (z >> 31);
+		}
+	}
+	// helper functions
+	inline uint64_t next() {
+		const uint64_t result = rotl(_s[1] * 5, 7) * 9;
+		const uint64_t t = _s[1] << 17;
+		_s[2] ^= _s[0];
+		_s[3] ^= _s[1];
+		_s[1] ^= _s[2];
+		_s[0] ^= _s[3];
+		_s[2] ^= t;
+		_s[3] = rotl(_s[3], 45);
+		return result;
+	}
+	inline int range(const int min, const int max) {
+		// return a random number from min to max (included), without modulo bias (Lemire's method)
+		const uint32_t size = (uint32_t) (max - min + 1);
+		uint64_t m = (next() >> 32) * size;
+		if ((uint32_t) m < size) {
+			const uint32_t threshold = -size % size;
+			while ((uint32_t) m < threshold) {
+				m = (next() >> 32) * size;
+			}
+		}
+		return min + (int) (m >> 32);
+	}
+	void jump() {
+		// advance the generator by 2^128 numbers
+		static const uint64_t JUMP[4] = {0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL, 0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL};
+		uint64_t s[4] = {0, 0, 0, 0};
+		for (int i = 0; i < 4; i++) {
+			for (int b = 0; b < 64; b++) {
+				if (JUMP[i] & (1ULL << b)) {
+					for (int k = 0; k < 4; k++) {
+						s[k] ^= _s[k];
+					}
+				}
+				next();
+			}
+		}
+		for (int k = 0; k < 4; k++) {
+			_s[k] = s[k];
+		}
+	}
+private:
+	uint64_t _s[4];
+	static inline uint64_t rotl(const uint64_t x, const int k) {return (x << k) | (x >> (64 - k));}
+};
+
+extern uint64_t MASTER_SEED; // seed of all the random numbers (0: seeded from the clock)
+extern thread_local random_generator RANDOM; // generator of the current thread
+
+random_generator new_random_stream();
+
+inline int random_range(const int min, const int max) {
+	return RANDOM.range(min, max);
+}
+
+class othello_game {
+public:
+	// constructor
+	othello_game() {
+		for (int i = 0; i < MAX_BOARD_SIZE; i++) {
+			for (int j = 0; j < MAX_BOARD_SIZE; j++) {
+				_othelloboard_piece[i][j] = piece::EMPTY;
+			}
+		}
+		std::fill(&_neighbours[0][0], &_neighbours[0][0] + 2 * MAX_BOARD_SIZE * MAX_BOARD_SIZE, 0);
+		std::fill(&_frontier[0][0], &_frontier[0][0] + 2 * SQUARE_WORDS, 0);
+		_count[0] = BOARD_SIZE * BOARD_SIZE;
+		_count[1] = 0;
+		_count[2] = 0;
+		// fill middle section
+		const int x = BOARD_SIZE / 2;
+		const int y = BOARD_SIZE / 2;
+		set_othelloboard_piece(x, y, piece::O);
+		set_othelloboard_piece(x-1, y-1, piece::O);
+		set_othelloboard_piece(x-1, y, piece::X);
+		set_othelloboard_piece(x, y-1, piece::X);
+	}
+	// note: the default copy constructor is a flat copy of the board
+	// getters
+	inline piece get_othelloboard_piece(const int row, const int col) const {return _othelloboard_piece[row][col];}
+	// setters
+	void set_othelloboard_piece(const int row, const int col, const piece p);
+	// helper function
+	inline void make_move(const int row, const int col, const piece p) {
+		set_othelloboard_piece(row, col, p);
+		execute_move(row, col, p);
+	}
+	// helper function prototypes
+	std::vector<std::tuple<int, int>> valid_moves(const piece p) const;
+	std::vector<std::tuple<int, int>> flipped_pieces(const int row, const int col, const piece p) const;
+	inline int score_board(const piece p) const {return _count[(int) p];}
+	void execute_move(const int row, const int col, const piece p, uint64_t *flipped = nullptr); // flipped receives the mask of the squares flipped
+	std::string get_position(const piece turn) const;
+	bool set_position(const std::string& position, piece &turn);
+private:
+	// the frontier (empty squares next to a piece) is kept up to date by set_othelloboard_piece(), so that the cost
+	// of a move depends on the number of pieces flipped, and valid_moves() only looks at the candidate squares
+	piece _othelloboard_piece[MAX_BOARD_SIZE][MAX_BOARD_SIZE];
+	uint8_t _neighbours[2][MAX_BOARD_SIZE * MAX_BOARD_SIZE]; // number of X and of O pieces next to each square
+	uint64_t _frontier[2][SQUARE_WORDS]; // empty squares next to an X piece, next to an O piece (row * BOARD_SIZE + col)
+	int _count[3]; // number of squares EMPTY, X and O
+};
+
+// return the usual name of a move: column letter, row number (a1 is the top left corner); "pass" for (-1, -1)
+std::string move_name(const int row, const int col);
+
+//----------------------------------------------------------------------------
+// Game record
+// the moves of a game, each with the mask of the squares it flipped, so that
+// undo() and redo() put the pieces back on the board in place, with no copy of
+// the board and no allocation (the log is reserved for the longest game of the
+// board size); the passes are not recorded, the turn after each move being
+// kept with it. a game is saved and read as the usual transcript of its moves
+// (e.g. "f5d6c3d3c4"), the passes being implied
+
+struct game_ply {
+	int8_t _row;
+	int8_t _col;
+	piece _player; // player of the move
+	piece _turn; // player to move after it, EMPTY if the game is over
+	uint64_t _flipped[SQUARE_WORDS]; // squares flipped by the move
+};
+
+class game_record {
+public:
+	// constructor: start of the game, X to move
+	game_record();
+	// getters
+	inline const othello_game& get_game() const {return _game;}
+	inline piece get_turn() const {return _turn;} // EMPTY if the game is over
+	inline int get_ply() const {return _ply;} // number of moves played
+	inline const game_ply& get_move(const int i) const {return _log[i];} // move i, from 0 to get_ply() - 1 (or to the last undone move)
+	inline bool can_undo() const {return _ply > 0;}
+	inline bool can_redo() const {return _ply < (int) _log.size();}
+	// helper functions
+	void play(const int row, const int col); // play valid move (row,col) for get_turn(); the undone moves are forgotten
+	void undo();
+	void redo();
+	std::string transcript() const; // the moves played, e.g. "f5d6c3"
+	bool set_transcript(const std::string& text); // replay the moves of text from the start; false (record unchanged) if a move is not valid
+	void reset(const othello_game& game, const piece turn); // start from game, turn to move (or to pass); the transcript has the moves played from there
+private:
+	othello_game _game;
+	piece _turn;
+	std::vector<game_ply> _log; // moves played, then moves undone
+	int _ply;
+};
+
+//----------------------------------------------------------------------------
+// Zobrist hashing
+// the hash of a position is the xor of one random key per (piece, square),
+// of a key per board size, and of a key for O to play
+
+struct zobrist_keys {
+	uint64_t _piece[2][MAX_BOARD_SIZE * MAX_BOARD_SIZE]; // keys of X and O on each square
+	uint64_t _flip[MAX_BOARD_SIZE * MAX_BOARD_SIZE]; // xor of the keys of X and O on each square
+	uint64_t _board_size[MAX_BOARD_SIZE + 1];
+	uint64_t _turn;
+	zobrist_keys() {
+		// fixed seed, so that hashes are the same from one run to the next
+		random_generator rng(0x07E11011ULL);
+		for (int square = 0; square < MAX_BOARD_SIZE * MAX_BOARD_SIZE; square++) {
+			_piece[0][square] = rng.next();
+			_piece[1][square] = rng.next();
+			_flip[square] = _piece[0][square] ^ _piece[1][square];
+		}
+		for (int size = 0; size <= MAX_BOARD_SIZE; size++) {
+			_board_size[size] = rng.next();
+		}
+		_turn = rng.next();
+	}
+};
+
+extern const zobrist_keys ZOBRIST;
+
+//----------------------------------------------------------------------------
+// Telemetry counters (compile with -DOTHELLO_TELEMETRY)
+// counts of the hot paths: moves generated, pieces flipped and heap allocations;
+// each thread adds to its own counters (no lock, no shared cache line), and
+// telemetry_totals() sums the counters of all the threads. without
+// OTHELLO_TELEMETRY, TELEMETRY_COUNT() compiles to nothing
+
+const int TELEMETRY_MOVES = 0;
+const int TELEMETRY_FLIPS = 1;
+const int TELEMETRY_ALLOCATIONS = 2;
+const int TELEMETRY_COUNTERS = 3;
+extern const char *TELEMETRY_COUNTER_NAME[TELEMETRY_COUNTERS];
+
+struct telemetry_counters {
+	long long _count[TELEMETRY_COUNTERS];
+};
+
+#ifdef OTHELLO_TELEMETRY
+struct thread_counters {
+	// counters of one thread, linked in the list of the living threads (no allocation: operator new is counted)
+	std::atomic<long long> _count[TELEMETRY_COUNTERS]; // only written by their thread
+	thread_counters *_next;
+	thread_counters();
+	~thread_counters();
+};
+extern thread_local thread_counters COUNTERS;
+#define TELEMETRY_COUNT(counter, n) COUNTERS._count[counter].store(COUNTERS._count[counter].load(std::memory_order_relaxed) + (n), std::memory_order_relaxed)
+#else
+#define TELEMETRY_COUNT(counter, n) ((void) 0)
+#endif
+
+// return the counts of all the threads since the start (zero without OTHELLO_TELEMETRY)
+telemetry_counters telemetry_totals();
+
+//----------------------------------------------------------------------------
+// Bitboards
+// square (row, col) of a N x N board is square (row * N + col), stored as
+// one bit of a set of 64 bits words; the board size is a template parameter,
+// so that each board size gets its own fully unrolled move generator
+
+// deltas, as constant expressions
+constexpr int DELTA_ROW[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+constexpr int DELTA_COL[8] = {-1, -1, 0, 1, 1, 1, 0, -1};
+
+template <int N> struct board_masks;
+
+template <int N>
+struct square_set {
+	static const int SQUARES = N * N;
+	static const int WORDS = (SQUARES + 63) / 64;
+	uint64_t _word[WORDS];
+	// helper functions
+	inline void clear() {
+		for (int i = 0; i < WORDS; i++) {_word[i] = 0;}
+	}
+	inline void set(const int square) {_word[square / 64] |= 1ULL << (square % 64);}
+	inline bool test(const int square) const {return (_word[square / 64] >> (square % 64)) & 1;}
+	inline bool empty() const {
+		uint64_t any = 0;
+		for (int i = 0; i < WORDS; i++) {any |= _word[i];}
+		return any == 0;
+	}
+	inline int count() const {
+		int total = 0;
+		for (int i = 0; i < WORDS; i++) {total += __builtin_popcountll(_word[i]);}
+		return total;
+	}
+	inline int nth_square(int n) const {
+		// return the n-th square of the set (n < count())
+		for (int i = 0; i < WORDS; i++) {
+			const int c = __builtin_popcountll(_word[i]);
+			if (n < c) {
+				uint64_t w = _word[i];
+				while (n-- > 0) {
+					w &= w - 1;
+				}
+				return i * 64 + __builtin_ctzll(w);
+			}
+			n -= c;
+		}
+		return -1;
+	}
+	inline square_set operator&(const square_set& s) const {
+		square_set r;
+		for (int i = 0; i < WORDS; i++) {r._word[i] = _word[i] & s._word[i];}
+		return r;
+	}
+	inline square_set operator|(const square_set& s) const {
+		square_set r;
+		for (int i = 0; i < WORDS; i++) {r._word[i] = _word[i] | s._word[i];}
+		return r;
+	}
+	inline square_set& operator&=(const square_set& s) {
+		for (int i = 0; i < WORDS; i++) {_word[i] &= s._word[i];}
+		return *this;
+	}
+	inline square_set& operator|=(const square_set& s) {
+		for (int i = 0; i < WORDS; i++) {_word[i] |= s._word[i];}
+		return *this;
+	}
+	inline square_set and_not(const square_set& s) const {
+		square_set r;
+		for (int i = 0; i < WORDS; i++) {r._word[i] = _word[i] & ~s._word[i];}
+		return r;
+	}
+	inline bool operator==(const square_set& s) const {
+		uint64_t diff = 0;
+		for (int i = 0; i < WORDS; i++) {diff |= _word[i] ^ s._word[i];}
+		return diff == 0;
+	}
+	template <int DIR> inline square_set shift() const {
+		// move every square one step in the direction deltas[DIR]
+		// squares wrapped around the board, or out of the board, are removed
+		const int S = DELTA_ROW[DIR] * N + DELTA_COL[DIR];
+		square_set r = shift_words<(S > 0) ? S : -S>(std::integral_constant<bool, (S > 0)>());
+		return r & board_masks<N>::instance._direction[DIR];
+	}
+private:
+	template <int S> inline square_set shift_words(std::true_type) const {
+		// shift towards the higher squares
+		square_set r;
+		for (int i = WORDS - 1; i > 0; i--) {r._word[i] = (_word[i] << S) | (_word[i - 1] >> (64 - S));}
+		r._word[0] = _word[0] << S;
+		return r;
+	}
+	template <int S> inline square_set shift_words(std::false_type) const {
+		// shift towards the lower squares
+		square_set r;
+		for (int i = 0; i < WORDS - 1; i++) {r._word[i] = (_word[i] >> S) | (_word[i + 1] << (64 - S));}
+		r._word[WORDS - 1] = _word[WORDS - 1] >> S;
+		return r;
+	}
+};
+
+template <int N>
+struct board_masks {
+	square_set<N> _board; // all the squares of the board
+	square_set<N> _direction[8]; // squares which can be reached by one step in each direction
+	square_set<N> _quarter[4]; // the four quarters of the board
+	board_masks() {
+		_board.clear();
+		for (int q = 0; q < 4; q++) {
+			_quarter[q].clear();
+		}
+		for (int dir = 0; dir < 8; dir++) {
+			_direction[dir].clear();
+		}
+		for (int i = 0; i < N; i++) {
+			for (int j = 0; j < N; j++) {
+				_board.set(i * N + j);
+				_quarter[2 * (i >= N / 2) + (j >= N / 2)].set(i * N + j);
+				for (int dir = 0; dir < 8; dir++) {
+					// (i,j) can be reached from (i,j) - delta
+					const int from_col = j - DELTA_COL[dir];
+					if (from_col >= 0 and from_col < N) {
+						_direction[dir].set(i * N + j);
+					}
+				}
+			}
+		}
+	}
+	static const board_masks instance;
+};
+
+template <int N> const board_masks<N> board_masks<N>::instance;
+
+template <int N>
+class bitboard {
+public:
+	// constructors
+	bitboard() {
+		_pieces[0].clear();
+		_pieces[1].clear();
+		_hash = ZOBRIST._board_size[N];
+	}
+	bitboard(const othello_game& game) {
+		_pieces[0].clear();
+		_pieces[1].clear();
+		_hash = ZOBRIST._board_size[N];
+		for (int i = 0; i < N; i++) {
+			for (int j = 0; j < N; j++) {
+				if (game.get_othelloboard_piece(i, j) != piece::EMPTY) {
+					_pieces[index(game.get_othelloboard_piece(i, j))].set(i * N + j);
+					_hash ^= ZOBRIST._piece[index(game.get_othelloboard_piece(i, j))][i * N + j];
+				}
+			}
+		}
+	}
+	// getters
+	inline const square_set<N>& get_pieces(const piece p) const {return _pieces[index(p)];}
+	inline uint64_t get_hash() const {return _hash;}
+	inline uint64_t get_hash(const piece turn) const {return _hash ^ ((turn == piece::O) ? ZOBRIST._turn : 0);}
+	inline square_set<N> get_empty() const {return board_masks<N>::instance._board.and_not(_pieces[0] | _pieces[1]);}
+	// helper functions
+	inline square_set<N> valid_moves(const piece p) const {
+		// return the set of all valid moves for p
+		const square_set<N>& own = _pieces[index(p)];
+		const square_set<N>& other = _pieces[1 - index(p)];
+		square_set<N> moves = line_end<0>(own, other) | line_end<1>(own, other) | line_end<2>(own, other) | line_end<3>(own, other);
+		moves |= line_end<4>(own, other) | line_end<5>(own, other) | line_end<6>(own, other) | line_end<7>(own, other);
+		moves &= get_empty();
+		TELEMETRY_COUNT(TELEMETRY_MOVES, moves.count());
+		return moves;
+	}
+	inline square_set<N> flips(const int square, const piece p) const {
+		// return the set of pieces flipped by move square for p
+		// it is assumed to be a valid move
+		const square_set<N>& own = _pieces[index(p)];
+		const square_set<N>& other = _pieces[1 - index(p)];
+		square_set<N> move;
+		move.clear();
+		move.set(square);
+		square_set<N> flipped = flip_line<0>(move, own, other) | flip_line<1>(move, own, other) | flip_line<2>(move, own, other) | flip_line<3>(move, own, other);
+		flipped |= flip_line<4>(move, own, other) | flip_line<5>(move, own, other) | flip_line<6>(move, own, other) | flip_line<7>(move, own, other);
+		return flipped;
+	}
+	inline void make_move(const int square, const piece p) {
+		// play square for p, and flip the pieces
+		execute_move(square, p, flips(square, p));
+	}
+	inline void execute_move(const int square, const piece p, const square_set<N>& flipped) {
+		// play square for p, and flip the pieces flipped
+		// the hash is updated incrementally
+		TELEMETRY_COUNT(TELEMETRY_FLIPS, flipped.count());
+		_hash ^= ZOBRIST._piece[index(p)][square];
+		for (int i = 0; i < square_set<N>::WORDS; i++) {
+			uint64_t w = flipped._word[i];
+			while (w) {
+				_hash ^= ZOBRIST._flip[i * 64 + __builtin_ctzll(w)];
+				w &= w - 1;
+			}
+		}
+		square_set<N> changed = flipped;
+		changed.set(square);
+		_pieces[index(p)] |= changed;
+		_pieces[1 - index(p)] = _pieces[1 - index(p)].and_not(flipped);
+	}
+	inline int score_board(const piece p) const {return _pieces[index(p)].count();}
+	inline bool operator==(const bitboard& b) const {return _pieces[0] == b._pieces[0] and _pieces[1] == b._pieces[1];}
+private:
+	square_set<N> _pieces[2]; // pieces X, pieces O
+	uint64_t _hash; // Zobrist hash of the pieces
+	static inline int index(const piece p) {return (p == piece::X) ? 0 : 1;}
+	template <int DIR> static inline square_set<N> line_end(const square_set<N>& own, const square_set<N>& other) {
+		// return the squares found after a line of other's pieces starting next to own's pieces
+		square_set<N> line = own.template shift<DIR>() & other;
+		for (int k = 0; k < N - 3; k++) {
+			line |= line.template shift<DIR>() & other;
+		}
+		return line.template shift<DIR>();
+	}
+	template <int DIR> static inline square_set<N> flip_line(const square_set<N>& move, const square_set<N>& own, const square_set<N>& other) {
+		// return the line of other's pieces starting next to move, if it is closed by one of own's pieces
+		square_set<N> line = move.template shift<DIR>() & other;
+		for (int k = 0; k < N - 3; k++) {
+			line |= line.template shift<DIR>() & other;
+		}
+		if ((line.template shift<DIR>() & own).empty()) {
+			line.clear();
+		}
+		return line;
+	}
+};
+
+template <int N>
+struct move_list {
+	// fixed capacity list of moves
+	int _size;
+	unsigned char _square[N * N];
+	inline void fill(const square_set<N>& moves) {
+		_size = 0;
+		for (int i = 0; i < square_set<N>::WORDS; i++) {
+			uint64_t w = moves._word[i];
+			while (w) {
+				_square[_size++] = (unsigned char) (i * 64 + __builtin_ctzll(w));
+				w &= w - 1;
+			}
+		}
+	}
+};
+
+//----------------------------------------------------------------------------
+// Symmetries
+// the 8 symmetries of the square board: symmetry s transposes the board (rows
+// and columns swapped) if s & 4, then flips it upside down if s & 2, then
+// mirrors it left to right if s & 1 (0 is the identity). the images of a
+// position have the same value: its canonical form is the image with the
+// smallest pieces (those of X, then those of O, compared as symmetric_board),
+// whose key is shared by the 8 orientations of the position
+
+const int SYMMETRIES = 8;
+
+inline int symmetric_square(const int square, const int s, const int n) {
+	// image of square (row * n + col) by symmetry s, on a board of size n
+	int row = square / n;
+	int col = square % n;
+	if (s & 4) {std::swap(row, col);}
+	if (s & 2) {row = n - 1 - row;}
+	if (s & 1) {col = n - 1 - col;}
+	return row * n + col;
+}
+
+inline int inverse_symmetry(const int s) {
+	// the symmetry undoing s (after a transposition, the flip and the mirror are exchanged)
+	return (s & 4) ? (4 | ((s & 1) << 1) | ((s & 2) >> 1)) : s;
+}
+
+inline uint64_t transpose_block(uint64_t x) {
+	// transposition of a block of 8 x 8 squares (a row per byte): swap the 4 x 4, then 2 x 2, then 1 x 1 blocks on each side of the diagonal
+	uint64_t t = 0x0F0F0F0F00000000ULL & (x ^ (x << 28));
+	x ^= t ^ (t >> 28);
+	t = 0x3333000033330000ULL & (x ^ (x << 14));
+	x ^= t ^ (t >> 14);
+	t = 0x5500550055005500ULL & (x ^ (x << 7));
+	x ^= t ^ (t >> 7);
+	return x;
+}
+
+inline uint64_t mirror_block(uint64_t x) {
+	// mirror of a block of 8 x 8 squares: reverse the bits of each byte
+	x = ((x >> 1) & 0x5555555555555555ULL) | ((x & 0x5555555555555555ULL) << 1);
+	x = ((x >> 2) & 0x3333333333333333ULL) | ((x & 0x3333333333333333ULL) << 2);
+	return ((x >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((x & 0x0F0F0F0F0F0F0F0FULL) << 4);
+}
+
+template <int N>
+struct symmetric_board {
+	// the pieces of a player on BLOCKS x BLOCKS blocks of 8 x 8 squares, a word per block (a row per byte, column c
+	// at bit c), the board in the top left corner: a symmetry is the same symmetry of each block (bit twiddling), the
+	// blocks being swapped, then the board is shifted back to the corner over the PAD rows or columns of padding
+	static const int BLOCKS = (N + 7) / 8;
+	static const int PAD = 8 * BLOCKS - N;
+	uint64_t _block[BLOCKS][BLOCKS]; // [row of blocks][column of blocks]
+	// constructors
+	symmetric_board() {}
+	explicit symmetric_board(const square_set<N>& set) {
+		if (N == 8) {
+			_block[0][0] = set._word[0];
+			return;
+		}
+		for (int r = 0; r < BLOCKS; r++) {
+			for (int c = 0; c < BLOCKS; c++) {
+				_block[r][c] = 0;
+			}
+		}
+		for (int row = 0; row < N; row++) {
+			const int first = row * N;
+			uint64_t bits = set._word[first / 64] >> (first % 64);
+			if (first % 64 + N > 64) {
+				bits |= set._word[first / 64 + 1] << (64 - first % 64);
+			}
+			bits &= (1ULL << N) - 1;
+			for (int c = 0; c < BLOCKS; c++) {
+				_block[row / 8][c] |= ((bits >> (8 * c)) & 0xFF) << (8 * (row % 8));
+			}
+		}
+	}
+	// getters
+	square_set<N> pieces() const {
+		square_set<N> set;
+		set.clear();
+		for (int row = 0; row < N; row++) {
+			uint64_t bits = 0;
+			for (int c = 0; c < BLOCKS; c++) {
+				bits |= ((_block[row / 8][c] >> (8 * (row % 8))) & 0xFF) << (8 * c);
+			}
+			const int first = row * N;
+			set._word[first / 64] |= bits << (first % 64);
+			if (first % 64 + N > 64) {
+				set._word[first / 64 + 1] |= bits >> (64 - first % 64);
+			}
+		}
+		return set;
+	}
+	// symmetries
+	symmetric_board transposed() const {
+		symmetric_board image;
+		for (int r = 0; r < BLOCKS; r++) {
+			for (int c = 0; c < BLOCKS; c++) {
+				image._block[c][r] = transpose_block(_block[r][c]);
+			}
+		}
+		return image;
+	}
+	symmetric_board flipped() const {
+		// upside down: the rows of each block and the rows of blocks reversed, then the board up by PAD rows (bytes)
+		symmetric_board image;
+		for (int r = 0; r < BLOCKS; r++) {
+			for (int c = 0; c < BLOCKS; c++) {
+				image._block[BLOCKS - 1 - r][c] = __builtin_bswap64(_block[r][c]);
+			}
+		}
+		for (int r = 0; PAD > 0 and r < BLOCKS; r++) {
+			for (int c = 0; c < BLOCKS; c++) {
+				image._block[r][c] >>= 8 * PAD % 64;
+				if (r + 1 < BLOCKS) {
+					image._block[r][c] |= image._block[r + 1][c] << (64 - 8 * PAD) % 64;
+				}
+			}
+		}
+		return image;
+	}
+	symmetric_board mirrored() const {
+		// left to right: the columns of each block and the columns of blocks reversed, then the board left by PAD columns (bits of each byte)
+		const uint64_t low = 0x0101010101010101ULL * (0xFF >> PAD); // bits of each byte kept by the shift
+		symmetric_board image;
+		for (int r = 0; r < BLOCKS; r++) {
+			for (int c = 0; c < BLOCKS; c++) {
+				image._block[r][BLOCKS - 1 - c] = mirror_block(_block[r][c]);
+			}
+		}
+		for (int r = 0; PAD > 0 and r < BLOCKS; r++) {
+			for (int c = 0; c < BLOCKS; c++) {
+				image._block[r][c] = (image._block[r][c] >> PAD) & low;
+				if (c + 1 < BLOCKS) {
+					image._block[r][c] |= (image._block[r][c + 1] << (8 - PAD)) & ~low;
+				}
+			}
+		}
+		return image;
+	}
+	// helper functions
+	inline int compare(const symmetric_board& b) const {
+		// order of the boards, block by block: -1 if this < b, 0 if equal, 1 if this > b
+		for (int r = 0; r < BLOCKS; r++) {
+			for (int c = 0; c < BLOCKS; c++) {
+				if (_block[r][c] != b._block[r][c]) {
+					return (_block[r][c] < b._block[r][c]) ? -1 : 1;
+				}
+			}
+		}
+		return 0;
+	}
+};
+
+template <int N>
+inline void symmetric_images(const square_set<N>& set, symmetric_board<N> image[SYMMETRIES]) {
+	// image of set by each symmetry: one transposition, then the flips and the mirrors of both
+	image[0] = symmetric_board<N>(set);
+	image[4] = image[0].transposed();
+	for (int s = 0; s < SYMMETRIES; s += 4) {
+		image[s + 1] = image[s].mirrored();
+		image[s + 2] = image[s].flipped();
+		image[s + 3] = image[s + 2].mirrored();
+	}
+}
+
+template <int N>
+uint64_t canonical_key(const square_set<N>& x, const square_set<N>& o, const bool o_turn, int *symmetries = nullptr) {
+	// return the key of the canonical form of the position of pieces x and o (O to move if o_turn)
+	// symmetries receives the set (bit s for symmetry s) of the symmetries mapping the position to its canonical form
+	symmetric_board<N> image[2][SYMMETRIES];
+	symmetric_images(x, image[0]);
+	symmetric_images(o, image[1]);
+	int best = 0;
+	int mask = 1;
+	for (int s = 1; s < SYMMETRIES; s++) {
+		int order = image[0][s].compare(image[0][best]);
+		if (order == 0) {
+			order = image[1][s].compare(image[1][best]);
+		}
+		if (order < 0) {
+			best = s;
+			mask = 1 << s;
+		} else if (order == 0) {
+			mask |= 1 << s;
+		}
+	}
+	if (symmetries != nullptr) {
+		*symmetries = mask;
+	}
+	// the blocks are mixed by the finalizer of splitmix64
+	uint64_t key = (uint64_t) N << 1 | (o_turn ? 1 : 0);
+	for (int p = 0; p < 2; p++) {
+		for (int r = 0; r < symmetric_board<N>::BLOCKS; r++) {
+			for (int c = 0; c < symmetric_board<N>::BLOCKS; c++) {
+				uint64_t z = key ^ image[p][best]._block[r][c];
+				z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+				z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+				key = (z ^ (z >> 31)) + 0x9E3779B97F4A7C15ULL;
+			}
+		}
+	}
+	return key;
+}
+
+template <int N>
+int position_symmetries(const square_set<N>& x, const square_set<N>& o) {
+	// return the set (bit s for symmetry s) of the symmetries leaving the position of pieces x and o unchanged
+	symmetric_board<N> image[2][SYMMETRIES];
+	symmetric_images(x, image[0]);
+	symmetric_images(o, image[1]);
+	int mask = 1;
+	for (int s = 1; s < SYMMETRIES; s++) {
+		if (image[0][s].compare(image[0][0]) == 0 and image[1][s].compare(image[1][0]) == 0) {
+			mask |= 1 << s;
+		}
+	}
+	return mask;
+}
+
+inline bool distinct_square(const int square, const int symmetries, const int n) {
+	// true if square is the smallest of its images by the symmetries of a position (one move per class of equivalent moves)
+	for (int s = 1; s < SYMMETRIES; s++) {
+		if (((symmetries >> s) & 1) and symmetric_square(square, s, n) < square) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// return the valid moves for p, one per class of moves equivalent by a symmetry of the position
+// (all of them if the position has no symmetry)
+std::vector<std::tuple<int, int>> distinct_moves(const othello_game& othello, const piece p);
+
+// return the key of a position, different for each of its orientations (the hash of bitboard::get_hash(turn))
+uint64_t position_key(const othello_game& othello, const piece turn);
+
+#ifdef OTHELLO_DEBUG
+extern thread_local long long ALLOCATION_COUNT; // number of heap allocations made by the current thread (see othello_engine.cpp)
+#endif
+
+//----------------------------------------------------------------------------
+
+inline int computer_win(const int score_player, const int score_computer) {
+	// return 1 if computer wins; -1 if player wins; 0 if tie
+	if (score_player < score_computer) {
+		return 1;
+	} else if (score_player > score_computer) {
+		return -1;
+	} else {
+		return 0;
+	}
+}
+
+//----------------------------------------------------------------------------
+// Pattern evaluation
+// static evaluation of a position by lookup tables: the squares of a pattern
+// (a line of the edge, the 3 x 3 block of a corner, the diagonal), read from
+// each corner of the board, make a base 3 index (empty, player to move,
+// opponent) into the table of the pattern; the evaluation is the sum of the
+// weights of the patterns, of a weight per move of mobility (difference of the
+// numbers of valid moves) and of a bias per number of empty squares (the parity
+// decides who plays last, an advantage in random games). it estimates the
+// final disc margin of the player to move in a random path, the weights being
+// fitted on random games (see othello_bench train), so that it can score a
+// path cut off early: the path is won with the probability that the margin,
+// taken as normally distributed around the evaluation, is positive
+
+const char EVAL_MAGIC[8] = {'O', 'T', 'H', 'E', 'V', 'A', 'L', '1'};
+const int EVAL_PATTERN = 3; // edge, corner, diagonal
+const int EVAL_PATTERN_LENGTH[EVAL_PATTERN] = {8, 9, 8}; // squares of a pattern (at most the board size for an edge and a diagonal)
+const int EVAL_MAX_INSTANCE = 16; // patterns read on a board: 8 edges, 4 corners, 4 diagonals
+
+class pattern_evaluator {
+public:
+	// constructor
+	pattern_evaluator() : _board_size(0), _mobility(0.f) {}
+	// getters
+	inline bool loaded() const {return _board_size > 0;}
+	inline int board_size() const {return _board_size;}
+	inline int number_instance() const {return (int) _instances.size();}
+	inline int instance_pattern(const int instance) const {return _instances[instance]._pattern;}
+	// weights, for the training
+	inline float& weight(const int pattern, const int index) {return _weights[pattern][index];}
+	inline float& mobility() {return _mobility;}
+	inline float& bias(const int empty) {return _bias[empty];}
+	inline float& deviation(const int empty) {return _deviation[empty];}
+	// helper functions
+	// set the patterns of board_size, with all the weights at 0
+	void reset(const int board_size);
+	// read the weights of file_name; return false (and no evaluator) if the file is missing or invalid
+	bool load(const std::string& file_name);
+	bool save(const std::string& file_name) const;
+	// fill the index of each pattern read on the board (number_instance() indexes), the mobility of turn and the number of empty squares
+	template <int N> inline void features(const bitboard<N>& board, const piece turn, int *indexes, int &mobility, int &empty) const {
+		const piece other = (turn == piece::X) ? piece::O : piece::X;
+		const square_set<N>& own = board.get_pieces(turn);
+		const square_set<N>& opponent = board.get_pieces(other);
+		read_patterns([&own, &opponent] (const int square) {return own.test(square) ? 1 : (opponent.test(square) ? 2 : 0);}, indexes);
+		mobility = board.valid_moves(turn).count() - board.valid_moves(other).count();
+		empty = board.get_empty().count();
+	}
+	void features(const othello_game& othello, const piece turn, int *indexes, int &mobility, int &empty) const;
+	// return the estimated final disc margin of turn
+	template <int N> inline float evaluate(const bitboard<N>& board, const piece turn) const {
+		int indexes[EVAL_MAX_INSTANCE];
+		int mobility;
+		int empty;
+		features(board, turn, indexes, mobility, empty);
+		return value(indexes, mobility, empty);
+	}
+	// return the probability that turn wins (logistic approximation of the normal distribution)
+	template <int N> inline float win_probability(const bitboard<N>& board, const piece turn) const {
+		int indexes[EVAL_MAX_INSTANCE];
+		int mobility;
+		int empty;
+		features(board, turn, indexes, mobility, empty);
+		return 1.f / (1.f + std::exp(-1.702f * value(indexes, mobility, empty) / _deviation[empty]));
+	}
+	inline float value(const int *indexes, const int mobility, const int empty) const {
+		float v = _bias[empty] + _mobility * mobility;
+		for (size_t i = 0; i < _instances.size(); i++) {
+			v += _weights[_instances[i]._pattern][indexes[i]];
+		}
+		return v;
+	}
+private:
+	struct pattern_instance {
+		int _pattern;
+		int _length;
+		int _square[9]; // row * board size + col, in the order of the base 3 digits
+	};
+	int _board_size;
+	std::vector<pattern_instance> _instances;
+	std::vector<float> _weights[EVAL_PATTERN];
+	float _mobility;
+	std::vector<float> _bias; // per number of empty squares
+	std::vector<float> _deviation; // standard deviation of the margin around the evaluation, per number of empty squares
+	template <typename F> inline void read_patterns(const F& square_value, int *indexes) const {
+		for (size_t i = 0; i < _instances.size(); i++) {
+			int index = 0;
+			for (int k = 0; k < _instances[i]._length; k++) {
+				index = 3 * index + square_value(_instances[i]._square[k]);
+			}
+			indexes[i] = index;
+		}
+	}
+};
+
+extern pattern_evaluator EVALUATOR; // read by init_engine(), if EVAL_FILE has the weights of BOARD_SIZE
+
+struct rollout_cutoff {
+	// random paths cut off after _depth moves, the position reached being scored by _evaluator (_depth 0: paths to the end)
+	const pattern_evaluator *_evaluator;
+	int _depth;
+	inline bool active() const {return _depth > 0 and _evaluator != nullptr and _evaluator->loaded();}
+};
+
+//----------------------------------------------------------------------------
+// Thread pool
+// the worker threads live for the whole process: each worker owns a deque of
+// the tasks it queued itself (it runs the newest one first); the tasks queued
+// by other threads (the searches, run by the game, the matches or the sessions
+// of the server) wait in a shared queue, run oldest first, so that concurrent
+// searches are served in turn, after the tasks of the threads set urgent (a
+// player waiting for a move); an idle worker steals the oldest task of another
+// worker
+
+class task_group {
+	// completion counter of a group of tasks
+public:
+	task_group() : _pending(0) {}
+	inline bool done() const {return _pending.load(std::memory_order_acquire) == 0;}
+	std::atomic<int> _pending;
+};
+
+class thread_pool {
+public:
+	// constructor: start number_thread workers
+	thread_pool(const int number_thread) : _queued(0), _stop(false) {
+		for (int i = 0; i < number_thread; i++) {
+			_workers.push_back(std::unique_ptr<worker>(new worker));
+		}
+		for (int i = 0; i < number_thread; i++) {
+			_threads.push_back(std::thread(&thread_pool::run, this, i));
+		}
+	}
+	// destructor: stop and join the workers
+	~thread_pool() {
+		{
+			std::lock_guard<std::mutex> lock(_sleep_mutex);
+			_stop = true;
+		}
+		_sleep.notify_all();
+		for (std::thread& t : _threads) {
+			t.join();
+		}
+	}
+	// getters
+	inline int get_number_thread() const {return (int) _workers.size();}
+	inline long long get_busy(const int w) const {return _workers[w]->_busy.load(std::memory_order_relaxed);} // nanoseconds spent in tasks by worker w
+	// setters
+	static inline void set_urgent(const bool urgent) {URGENT = urgent;} // the tasks queued by the current thread from now on run before the others
+	// helper functions
+	void submit(task_group& group, const std::function<void()>& run) {
+		// queue run in the deque of the current worker (or in a shared queue, outside of the pool)
+		group._pending.fetch_add(1, std::memory_order_relaxed);
+		worker& queue = (WORKER_INDEX >= 0) ? *_workers[WORKER_INDEX] : ((URGENT) ? _urgent : _shared);
+		{
+			std::lock_guard<std::mutex> lock(queue._mutex);
+			queue._tasks.push_back(task(run, &group));
+		}
+		{
+			std::lock_guard<std::mutex> lock(_sleep_mutex);
+			_queued++;
+		}
+		_sleep.notify_one();
+	}
+	void wait(task_group& group) {
+		// wait until all the tasks of group are done
+		// a worker runs the queued tasks meanwhile (tasks may wait for their own sub-tasks)
+		while (not group.done()) {
+			if (WORKER_INDEX >= 0 and run_one(WORKER_INDEX, false)) {
+				continue;
+			}
+			std::unique_lock<std::mutex> lock(_done_mutex);
+			_done.wait_for(lock, std::chrono::milliseconds(1), [&group] {return group.done();});
+		}
+	}
+private:
+	struct task {
+		std::function<void()> _run;
+		task_group *_group;
+		task(const std::function<void()>& run, task_group *group) : _run(run), _group(group) {}
+	};
+	struct worker {
+		std::mutex _mutex;
+		std::deque<task> _tasks;
+		std::atomic<long long> _busy; // nanoseconds spent in tasks
+		worker() : _busy(0) {}
+	};
+	std::vector<std::unique_ptr<worker>> _workers;
+	worker _urgent; // tasks queued from outside of the pool, by urgent threads
+	worker _shared; // tasks queued from outside of the pool, by the other threads
+	std::vector<std::thread> _threads;
+	std::mutex _sleep_mutex; // protects _queued and _stop
+	std::condition_variable _sleep;
+	int _queued; // number of tasks in the deques
+	bool _stop;
+	std::mutex _done_mutex;
+	std::condition_variable _done;
+	static thread_local int WORKER_INDEX; // index of the current worker; -1 outside of the pool
+	static thread_local bool URGENT; // the current thread queues urgent tasks
+	bool pop(const int w, task& t) {
+		// take the newest task of worker w, or else the oldest shared task (urgent first), or else the oldest task of another worker
+		{
+			std::lock_guard<std::mutex> lock(_workers[w]->_mutex);
+			if (not _workers[w]->_tasks.empty()) {
+				t = _workers[w]->_tasks.back();
+				_workers[w]->_tasks.pop_back();
+				return true;
+			}
+		}
+		for (worker *queue : {&_urgent, &_shared}) {
+			std::lock_guard<std::mutex> lock(queue->_mutex);
+			if (not queue->_tasks.empty()) {
+				t = queue->_tasks.front();
+				queue->_tasks.pop_front();
+				return true;
+			}
+		}
+		for (int k = 1; k < (int) _workers.size(); k++) {
+			worker& victim = *_workers[(w + k) % _workers.size()];
+			std::lock_guard<std::mutex> lock(victim._mutex);
+			if (not victim._tasks.empty()) {
+				t = victim._tasks.front();
+				victim._tasks.pop_front();
+				return true;
+			}
+		}
+		return false;
+	}
+	bool run_one(const int w, const bool busy) {
+		// run one task; return false if no task was found
+		// its time is added to the busy time of w if busy (not for the tasks run while waiting, part of the waiting task)
+		task t(nullptr, nullptr);
+		if (not pop(w, t)) {
+			return false;
+		}
+		{
+			std::lock_guard<std::mutex> lock(_sleep_mutex);
+			_queued--;
+		}
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		t._run();
+		if (busy) {
+			// before the task is counted as done, so that the waiting thread sees it
+			_workers[w]->_busy += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+		}
+		if (t._group->_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			std::lock_guard<std::mutex> lock(_done_mutex);
+			_done.notify_all();
+		}
+		return true;
+	}
+	void run(const int w) {
+		WORKER_INDEX = w;
+		while (true) {
+			if (run_one(w, true)) {
+				continue;
+			}
+			std::unique_lock<std::mutex> lock(_sleep_mutex);
+			_sleep.wait(lock, [this] {return _stop or _queued > 0;});
+			if (_stop) {
+				break;
+			}
+		}
+	}
+};
+
+extern thread_pool *POOL; // pool of NUMBER_PROCESSOR workers, set by main()
+
+//----------------------------------------------------------------------------
+// Transposition table
+// fixed size hash table of positions, shared by all the threads without lock:
+// an entry is two atomic words, the data and the key xor-ed with the data, so
+// that an entry torn by two concurrent writes is detected (and ignored)
+// the data of an entry is either Monte Carlo statistics (visits and wins of
+// the player who played the last move) or solver bounds (final disc margin)
+
+const int TT_BUCKET = 4; // entries per bucket (one cache line)
+const int TT_MONTE_CARLO = 1; // kinds of data
+const int TT_SOLVER = 2;
+const int TT_BOUND = 511; // infinite bound of a stored margin
+
+struct tt_entry {
+	std::atomic<uint64_t> _check; // key ^ data
+	std::atomic<uint64_t> _data;
+};
+
+inline uint64_t tt_monte_carlo(const int visits, const float wins) {
+	// data: kind (2 bits), visits (30 bits), number of half wins (32 bits)
+	return TT_MONTE_CARLO | ((uint64_t) (visits & 0x3FFFFFFF) << 2) | ((uint64_t) (2.f * wins) << 32);
+}
+
+inline int tt_visits(const uint64_t data) {return (int) ((data >> 2) & 0x3FFFFFFF);}
+inline float tt_wins(const uint64_t data) {return (data >> 32) / 2.f;}
+
+inline uint64_t tt_solver(const int lower, const int upper, const int move, const int empty) {
+	// data: kind (2 bits), lower and upper bounds of the margin (10 bits each),
+	// best move + 1 (9 bits), number of empty squares (9 bits)
+	const uint64_t l = std::max(-TT_BOUND, std::min(TT_BOUND, lower)) + 512;
+	const uint64_t u = std::max(-TT_BOUND, std::min(TT_BOUND, upper)) + 512;
+	return TT_SOLVER | (l << 2) | (u << 12) | ((uint64_t) (move + 1) << 22) | ((uint64_t) empty << 31);
+}
+
+inline int tt_lower(const uint64_t data) {return (int) ((data >> 2) & 0x3FF) - 512;}
+inline int tt_upper(const uint64_t data) {return (int) ((data >> 12) & 0x3FF) - 512;}
+inline int tt_move(const uint64_t data) {return (int) ((data >> 22) & 0x1FF) - 1;}
+inline int tt_empty(const uint64_t data) {return (int) ((data >> 31) & 0x1FF);}
+
+inline uint64_t tt_priority(const uint64_t data) {
+	// work represented by an entry: the entry with the lowest priority of a bucket is replaced first
+	if ((data & 3) == TT_MONTE_CARLO) {
+		return tt_visits(data);
+	} else if ((data & 3) == TT_SOLVER) {
+		return 1ULL << std::min(tt_empty(data), 40);
+	}
+	return 0;
+}
+
+class transposition_table {
+public:
+	// constructor
+	transposition_table() : _mask(0) {}
+	// helper functions
+	void resize(const int megabytes) {
+		// allocate (and clear) a table of megabytes MB (rounded down to a power of 2 buckets)
+		size_t buckets = 1;
+		while (2 * buckets * TT_BUCKET * sizeof(tt_entry) <= (size_t) megabytes << 20) {
+			buckets *= 2;
+		}
+		_entries.reset(new tt_entry[buckets * TT_BUCKET]);
+		_mask = buckets - 1;
+		clear();
+	}
+	void clear() {
+		for (size_t i = 0; i < (_mask + 1) * TT_BUCKET; i++) {
+			_entries[i]._check.store(0, std::memory_order_relaxed);
+			_entries[i]._data.store(0, std::memory_order_relaxed);
+		}
+	}
+	inline bool probe(const uint64_t key, uint64_t &data) const {
+		// return true, and the data of key, if key is in the table
+		if (not _entries) {
+			return false;
+		}
+		const tt_entry *bucket = &_entries[(key & _mask) * TT_BUCKET];
+		for (int i = 0; i < TT_BUCKET; i++) {
+			const uint64_t d = bucket[i]._data.load(std::memory_order_relaxed);
+			if ((bucket[i]._check.load(std::memory_order_relaxed) ^ d) == key and d != 0) {
+				data = d;
+				return true;
+			}
+		}
+		return false;
+	}
+	inline void store(const uint64_t key, const uint64_t data) {
+		// store data for key, replacing the same key, or else the entry of the bucket with the lowest priority
+		if (not _entries) {
+			return;
+		}
+		tt_entry *bucket = &_entries[(key & _mask) * TT_BUCKET];
+		int replace = 0;
+		uint64_t lowest = ~0ULL;
+		for (int i = 0; i < TT_BUCKET; i++) {
+			const uint64_t d = bucket[i]._data.load(std::memory_order_relaxed);
+			if ((bucket[i]._check.load(std::memory_order_relaxed) ^ d) == key) {
+				replace = i;
+				break;
+			}
+			const uint64_t priority = tt_priority(d);
+			if (priority < lowest) {
+				lowest = priority;
+				replace = i;
+			}
+		}
+		bucket[replace]._check.store(key ^ data, std::memory_order_relaxed);
+		bucket[replace]._data.store(data, std::memory_order_relaxed);
+	}
+private:
+	std::unique_ptr<tt_entry[]> _entries;
+	size_t _mask; // number of buckets - 1
+};
+
+extern transposition_table TRANSPOSITION_TABLE; // shared by all the searches, allocated by init_engine()
+
+//----------------------------------------------------------------------------
+// Opening book
+// binary file of moves with their results, sorted by position key then move,
+// built offline (see othello_bench book) and memory-mapped read only, so that
+// it loads at once and its pages are shared by the processes which use it
+// the key of a position is the key of its canonical form (see Symmetries),
+// and its moves are stored in the orientation of the canonical form, so that
+// an entry covers the 8 orientations of the position; the words are stored
+// in the byte order of the processor (little endian on x86)
+
+const char BOOK_MAGIC[8] = {'O', 'T', 'H', 'B', 'O', 'O', 'K', '3'};
+const int BOOK_MIN_GAMES = 8; // a book move must have been played in this number of games at least
+
+struct book_header {
+	char _magic[8]; // BOOK_MAGIC
+	uint32_t _board_size;
+	uint32_t _reserved;
+	uint64_t _number_entry; // number of book_entry following the header
+};
+
+struct book_entry {
+	uint64_t _key; // book_key() of the position
+	uint32_t _games; // number of games where the move was played
+	uint32_t _points; // half points of the player to move in these games: 2 per win, 1 per draw
+	uint16_t _move; // row * board size + col, in the orientation of the canonical form (see book_square())
+	uint16_t _reserved[3];
+};
+
+// return the key of a position in the book (see canonical_key())
+// symmetries receives the symmetries mapping the position to its canonical form (see book_square() and game_square())
+uint64_t book_key(const othello_game& othello, const piece turn, int *symmetries = nullptr);
+
+// return the square of the book for square of the game (the smallest of its images by the symmetries given by book_key())
+int book_square(const int square, const int symmetries);
+
+// return the square of the game for square of the book
+int game_square(const int square, const int symmetries);
+
+class opening_book {
+public:
+	// constructor, destructor
+	opening_book() : _entries(nullptr), _number_entry(0), _board_size(0), _view(nullptr), _view_size(0), _file(nullptr), _mapping(nullptr) {}
+	~opening_book() {close();}
+	opening_book(const opening_book&) = delete;
+	opening_book& operator=(const opening_book&) = delete;
+	// getters
+	inline bool loaded() const {return _view != nullptr;}
+	inline int board_size() const {return _board_size;}
+	inline size_t size() const {return _number_entry;}
+	inline const book_entry *begin() const {return _entries;}
+	inline const book_entry *end() const {return _entries + _number_entry;}
+	// helper functions
+	// map file_name; return false (and no book) if the file is missing or is not a book
+	bool open(const std::string& file_name);
+	void close();
+	// return the entries of the position key
+	std::tuple<const book_entry*, const book_entry*> find(const uint64_t key) const;
+	// return the best move of the position key (row * board size + col), and its score (expected points of
+	// the player to move); -1 if the position is not in the book, or if its moves were played in too few games
+	int best_move(const uint64_t key, double &score) const;
+	// sort and merge entries (same key and move), and write them to file_name; return false on error
+	static bool write(const std::string& file_name, const int board_size, std::vector<book_entry> entries);
+private:
+	const book_entry *_entries;
+	size_t _number_entry;
+	int _board_size;
+	void *_view; // mapped file
+	size_t _view_size;
+	void *_file; // Windows handles
+	void *_mapping;
+};
+
+extern opening_book BOOK; // mapped by init_engine(), if BOOK_FILE is a book of BOARD_SIZE
+
+//----------------------------------------------------------------------------
+// Search limits
+
+typedef std::chrono::steady_clock search_clock;
+
+struct search_limits {
+	// a search runs a fixed number of paths, or else (anytime search) until a deadline
+	// (an anytime search may also have a number of paths, then it stops at whichever comes first)
+	int _number_path;
+	bool _timed;
+	search_clock::time_point _deadline;
+	bool _reuse; // the paths of the subtree kept from the previous search (pondering) count toward _number_path
+	const std::atomic<bool> *_stop; // the search stops when it is set (nullptr: never)
+	// constructors
+	search_limits(const int number_path) : _number_path(number_path), _timed(false), _reuse(false), _stop(nullptr) {}
+	search_limits(const search_clock::time_point deadline) : _number_path(0), _timed(true), _deadline(deadline), _reuse(false), _stop(nullptr) {}
+	// helper functions
+	inline bool stopped() const {return _stop != nullptr and _stop->load(std::memory_order_relaxed);}
+	inline bool expired() const {return stopped() or (_timed and search_clock::now() >= _deadline);}
+};
+
+struct search_candidate {
+	// statistics of a move of the root
+	int _row;
+	int _col;
+	long long _paths; // random paths of the move (visits of a tree search)
+	double _score; // estimated probability of a win
+	// half width of the 95% confidence interval of _score
+	inline double confidence() const {return (_paths > 0) ? 1.96 * std::sqrt(_score * (1. - _score) / _paths) : 1.;}
+};
+
+//----------------------------------------------------------------------------
+// Engine
+// one class per board size, selected by create_engine(); an instance keeps
+// the trees of its searches, and must not run two searches at the same time
+
+class othello_engine {
+public:
+	virtual ~othello_engine() {}
+	// return the number of random paths won by p, after p has played (play_row, play_col)
+	// the paths are cut off as cutoff says
+	virtual int score_move(const othello_game& game, const int play_row, const int play_col, const piece p, const int number_path, const rollout_cutoff& cutoff) const = 0;
+	// return the best move for p (row * BOARD_SIZE + col) found by Monte Carlo tree search, and its score
+	// each of the number_thread trees runs as a task of POOL within limits (number of iterations per tree, or deadline)
+	// paths receives the number of iterations run by all the trees, candidates the statistics of the moves of the root
+	virtual int search_tree(const othello_game& game, const piece p, const int number_thread, const search_limits& limits, const rollout_cutoff& cutoff, double &score, long long &paths, std::vector<search_candidate>& candidates) = 0;
+	// return the best move for p (row * BOARD_SIZE + col) found by the exact endgame solver, and its final disc margin
+	// nodes receives the number of positions searched; once stop is set (if not nullptr), the search returns at once,
+	// with the best move found so far and no valid margin
+	virtual int solve_endgame(const othello_game& game, const piece p, int &margin, long long &nodes, const std::atomic<bool> *stop) const = 0;
+	// return the number of leaf nodes of the game tree to depth (perft), p to play, with the bitboards
+	// the subtrees are counted as tasks of POOL if parallel
+	virtual long long perft(const othello_game& game, const piece p, const int depth, const bool parallel) const = 0;
+};
+
+std::unique_ptr<othello_engine> create_engine(const int board_size);
+
+extern othello_engine *ENGINE; // engine for BOARD_SIZE, set by init_engine()
+
+void init_engine();
+
+// return the instruction set used for the random paths of score_move() ("none" if they are played one by one)
+const char *simd_playouts_name();
+
+// return the number of leaf nodes of the game tree to depth (perft), p to play, with the rules of othello_game
+long long game_perft(const othello_game& othello, const piece p, const int depth);
+
+//----------------------------------------------------------------------------
+// Search
+// choice of a move: exact endgame, tree search or flat Monte Carlo
+
+class ponder_search;
+extern ponder_search PONDER; // search on the player's time of the game
+class telemetry_stream;
+extern telemetry_stream TELEMETRY; // opened by init_engine(), if TELEMETRY_FILE is set
+struct search_result;
+
+// called during a search with the statistics of the moves so far (flat Monte Carlo: after each round,
+// tree search: every few hundred milliseconds, endgame: once solved)
+typedef std::function<void(const search_result& result)> search_report;
+
+struct search_parameters {
+	// parameters of a search; by default, the parameters above (command line)
+	int _number_thread; // number of trees, or number of batches per move and per round of a timed flat search
+	int _number_path; // Monte Carlo paths per move
+	char _ai_mode; // 'F'lat Monte Carlo, 'T'ree search
+	int _endgame_empty; // number of empty squares from which the game is solved exactly
+	const opening_book *_book; // book looked up before any search (nullptr: none)
+	rollout_cutoff _cutoff; // random paths cut off and scored by an evaluator
+	bool _pruning; // flat Monte Carlo: moves pruned on confidence bounds after each round of paths
+	const ponder_search *_ponder; // search run on the player's time, whose paths are credited on a ponder hit (nullptr: none)
+	telemetry_stream *_telemetry; // stream of the telemetry of the search (nullptr: none)
+	const std::atomic<bool> *_stop; // the search stops within milliseconds once it is set, with the best move so far (nullptr: never)
+	search_report _report; // statistics of the moves during the search (empty: none)
+	search_parameters() : _number_thread(NUMBER_PROCESSOR), _number_path(NUMBER_MONTE_CARLO_PATH), _ai_mode(AI_MODE), _endgame_empty(ENDGAME_EMPTY), _book(&BOOK), _cutoff({&EVALUATOR, ROLLOUT_DEPTH}), _pruning(ROOT_PRUNING), _ponder(&PONDER), _telemetry(&TELEMETRY), _stop(nullptr), _report() {}
+};
+
+struct search_result {
+	int _row; // best move; -1 if there is no valid move
+	int _col;
+	double _score; // estimated probability of a win (1 for a proven win, 0.5 for a draw, 0 for a loss)
+	bool _solved; // true if the move was found by the endgame solver (false if the solver was stopped)
+	int _margin; // final disc margin, if solved
+	long long _paths; // number of random paths played
+	long long _nodes; // number of positions searched by the endgame solver
+	bool _book; // true if the move was found in the opening book
+	bool _ponder_hit; // true if the search credited the paths run while the player was thinking
+	std::vector<search_candidate> _candidates; // statistics of the moves searched by Monte Carlo
+};
+
+// called with the move being assessed, or with the best move so far (-1, -1 when unknown)
+typedef std::function<void(const int row, const int col)> search_progress;
+
+int computer_move_time(const othello_game& othello);
+search_result search_move(othello_engine& engine, const search_parameters& parameters, const othello_game& othello, const piece p, const int move_time, const search_progress& progress = nullptr);
+search_result search_move(const othello_game& othello, const piece p, const int move_time, const search_progress& progress = nullptr);
+
+//----------------------------------------------------------------------------
+// Telemetry
+// optional stream of one JSON object per line and per search (see search_move()), to follow the
+// throughput of the engine: the paths and their speed, the busy and idle time of each worker of
+// POOL during the search, the score of each move with its confidence, the move played, and the
+// counters above when they are compiled in
+
+class telemetry_stream {
+public:
+	// helper functions
+	bool open(const std::string& file_name); // append to file_name; return false if it cannot be opened
+	void close();
+	inline bool active() const {return _file.is_open();}
+	void write(const std::string& line); // write line and a new line, from any thread
+private:
+	std::mutex _mutex;
+	std::ofstream _file;
+};
+
+//----------------------------------------------------------------------------
+// Pondering
+// while the player thinks, a thread searches the position with the player to
+// move: the tree search grows the trees that the computer's search reroots at
+// the player's reply, the flat Monte Carlo assesses the computer's moves after
+// the player's most likely replies. on a ponder hit (the player plays one of
+// them), search_move() credits the paths already run and only runs what is left
+// of its budget; the work on the other replies is dropped. the thread searches
+// by slices, and pauses after each slice to keep its share of the CPU
+
+struct ponder_reply {
+	// position after a reply of the player, and statistics of the computer's moves (flat Monte Carlo)
+	uint64_t _key; // position_key() of the position, computer to move
+	othello_game _othello;
+	std::vector<std::tuple<int, int>> _moves; // the computer's moves, as searched (see distinct_moves())
+	std::vector<int> _count_win; // number of paths won by the computer, per move
+	int _count_path; // number of paths per move
+};
+
+class ponder_search {
+public:
+	// constructor
+	ponder_search() : _engine(nullptr), _turn(piece::X), _cpu(0), _stop(false), _paths(0), _busy(0.) {}
+	// destructor: stop the thread (the caller should stop it while POOL still exists)
+	~ponder_search() {stop();}
+	// getters (once stopped)
+	inline long long get_paths() const {return _paths;}
+	inline double paths_per_ms() const {return (_busy > 0.) ? _paths / _busy : 0.;}
+	// helper functions
+	// start pondering othello, p (the player) to move, with at most cpu percent of the CPU
+	// the engine must not run another search until stop()
+	void start(othello_engine& engine, const search_parameters& parameters, const othello_game& othello, const piece p, const int cpu);
+	void start(const othello_game& othello, const piece p); // ENGINE, the parameters of the command line and PONDER_CPU
+	// stop pondering, within one slice
+	void stop();
+	// return the pondered reply of the player that leads to othello, p (the computer) to move; nullptr if none (once stopped)
+	const ponder_reply *find(const othello_game& othello, const piece p) const;
+private:
+	othello_engine *_engine;
+	search_parameters _parameters;
+	othello_game _othello; // position pondered
+	piece _turn; // the player
+	int _cpu;
+	std::thread _thread;
+	std::mutex _mutex; // protects _stop
+	std::condition_variable _wake;
+	bool _stop;
+	std::vector<ponder_reply> _replies;
+	long long _paths; // number of paths run
+	double _busy; // time spent searching, in milliseconds
+	void run();
+	long long ponder_flat();
+};
+
+#endif
@@ -0,0 +1,653 @@
+/*
+	Othello server: the engine without any display, driven by a GUI or a script through
+	the NBoard text protocol on the standard input and output; the engine, its threads,
+	its transposition table and its book stay loaded from one game to the next, and
+	many games (sessions) can be played at the same time on one pool of threads
+
+	Compile options (any platform, no Windows specific code):
+	g++ -Wall -O3 -o othello_server othello_server.cpp othello_engine.cpp -std=c++11 -pthread
+*/
+
+#include <iostream>
+#include <sstream>
+#include <iomanip>    // setprecision()
+#include <string>
+#include <map>
+#include <algorithm>  // sort(), find()
+#include <cctype>     // isdigit(), tolower()
+#include <cstdlib>    // atoi(), strtoull()
+#include "othello_engine.h"
+
+const char *USAGE =
+"syntax:\n"
+"othello_server <board_size> <processors> <monte_carlo> <ai_mode> <move_time> <endgame> <hash_size> <book_file> <seed> <sessions> <searches> <game_time>\n"
+"\n"
+"reads commands of the NBoard protocol, one per line, on the standard input, and\n"
+"writes the replies on the standard output; the searches run in the background,\n"
+"so that any command (stop, ping...) is answered while the engine thinks\n"
+"\n"
+"with <sessions> > 0, each line starts with the name of its session (any word),\n"
+"and so does each reply; a session is opened by its first line, and closed by\n"
+"quit. the searches of the sessions share the threads: <searches> run at the\n"
+"same time, the others wait, the searches of go (a player waits for the move)\n"
+"before those of hint, then those of the sessions which have searched the least;\n"
+"a go stops the oldest hint when all the searches are busy. a session beyond\n"
+"<sessions>, or a hint when too many searches wait, is answered status busy\n"
+"\n"
+"nboard <version>      start of the session: replies set myname <name>\n"
+"set game <ggf>        sets the game (GGF: start board BO[], then moves B[] and W[])\n"
+"set depth <depth>     sets the Monte Carlo paths per move to <depth> x 1000\n"
+"set contempt <n>      ignored\n"
+"move <move>[/...]     plays <move> (e.g. F5, PA for a pass) in the game\n"
+"go                    searches the game, and replies === <move>/<eval>/<seconds>\n"
+"hint <n>              searches the game, and replies search <move> <eval> 0 <depth>\n"
+"                      for its <n> best moves, as the search goes, then status\n"
+"ping <n>              stops the search, and replies pong <n> once it is over\n"
+"learn                 replies learned\n"
+"quit                  stops the search, and ends the server\n"
+"extensions:\n"
+"stop                  stops the search: go replies with the best move so far\n"
+"set time <ms>         sets the time per move in milliseconds (0: uses the paths)\n"
+"set paths <paths>     sets the Monte Carlo paths per move\n"
+"set position <text>   sets the game to a position, or to moves from the start\n"
+"\n"
+"<eval> is the final disc margin for the player to move once the game is solved,\n"
+"and otherwise (2 x score - 1) x squares, score being the estimated probability of\n"
+"a win; <depth> is the number of random paths of the move (empty squares, solved)\n"
+"\n"
+"<board_size>   the size of the board                          (default = 8, even number from 4 to 16)\n"
+"<processors>   number of core processors to use               (default = 4)\n"
+"<monte_carlo>  Monte Carlo paths per move                     (default = 20000)\n"
+"<ai_mode>      F:flat Monte Carlo, T:Monte Carlo tree search  (default = F)\n"
+"<move_time>    time per move in milliseconds                  (default = 0, uses <monte_carlo> paths per move)\n"
+"<endgame>      number of empty squares solved exactly         (default = 14, 0 to never solve)\n"
+"<hash_size>    transposition table in MB                      (default = 64, 0 for no table)\n"
+"<book_file>    file of the opening book, played by go         (default = none)\n"
+"<seed>         seed of the random numbers, 0 from the clock   (default = 0)\n"
+"<sessions>     maximum number of sessions                     (default = 0, one session, lines without names)\n"
+"<searches>     number of searches run at the same time, sharing <processors> threads\n"
+"               (default = 1 with one session, <processors> otherwise)\n"
+"<game_time>    time of the computer for a game of a session in seconds, shared between\n"
+"               its moves (default = 0, uses <move_time>; set time caps the time per move)\n"
+"\n"
+"positions are written as one character per square (X, O or -), row by row,\n"
+"followed by the player to move; X (black, * in GGF) plays first\n";
+
+const char *SERVER_NAME = "Othello";
+const int DEPTH_PATHS = 1000; // Monte Carlo paths per move of a unit of the depth of NBoard
+const int HINT_INTERVAL = 200; // minimum time between two sets of hints in milliseconds (the last one is always sent)
+int SERVER_SESSIONS = 0; // maximum number of sessions (0: one session, whose lines have no name)
+int SERVER_SEARCHES = 0; // number of searches run at the same time (0: 1 with one session, NUMBER_PROCESSOR otherwise)
+const int SERVER_QUEUE_FACTOR = 4; // a hint is refused when this number of searches per slot wait
+
+void init_server_variables(int argc, char ** argv) {
+	// re-initialize global variables from command line
+	if (argc >= 2) {BOARD_SIZE = (int) std::atoi(argv[1]);}
+	if (BOARD_SIZE < 4) {BOARD_SIZE = 4;}
+	if (BOARD_SIZE % 2 == 1) {BOARD_SIZE++;}
+	if (BOARD_SIZE > MAX_BOARD_SIZE) {BOARD_SIZE = MAX_BOARD_SIZE;}
+	if (argc >= 3) {NUMBER_PROCESSOR = (int) std::atoi(argv[2]);}
+	if (NUMBER_PROCESSOR < 1) {NUMBER_PROCESSOR = 1;}
+	if (argc >= 4) {NUMBER_MONTE_CARLO_PATH = (int) std::atoi(argv[3]);}
+	if (NUMBER_MONTE_CARLO_PATH < 100) {NUMBER_MONTE_CARLO_PATH = 100;}
+	if (argc >= 5) {const std::string str(argv[4]); AI_MODE = (char) str[0];}
+	if (AI_MODE != 'T') {AI_MODE = 'F';}
+	if (argc >= 6) {MOVE_TIME = (int) std::atoi(argv[5]);}
+	if (MOVE_TIME < 0) {MOVE_TIME = 0;}
+	if (argc >= 7) {ENDGAME_EMPTY = (int) std::atoi(argv[6]);}
+	if (ENDGAME_EMPTY < 0) {ENDGAME_EMPTY = 0;}
+	if (argc >= 8) {HASH_SIZE = (int) std::atoi(argv[7]);}
+	if (HASH_SIZE < 0) {HASH_SIZE = 0;}
+	if (argc >= 9) {BOOK_FILE = argv[8];}
+	if (argc >= 10) {MASTER_SEED = (uint64_t) std::strtoull(argv[9], nullptr, 10);}
+	if (argc >= 11) {SERVER_SESSIONS = (int) std::atoi(argv[10]);}
+	if (SERVER_SESSIONS < 0) {SERVER_SESSIONS = 0;}
+	if (argc >= 12) {SERVER_SEARCHES = (int) std::atoi(argv[11]);}
+	if (SERVER_SEARCHES < 1) {SERVER_SEARCHES = (SERVER_SESSIONS == 0) ? 1 : NUMBER_PROCESSOR;}
+	if (argc >= 13) {GAME_TIME = (int) std::atoi(argv[12]);}
+	if (GAME_TIME < 0) {GAME_TIME = 0;}
+}
+
+//----------------------------------------------------------------------------
+// Notation
+// NBoard writes the moves in upper case (F5), a pass as PA, and the games in
+// the Generic Game Format: (;GM[Othello]...BO[8 <board> <turn>]B[F5//1.2]W[D6]...;)
+
+bool read_move(const std::string& text, int &row, int &col) {
+	// read a move (e.g. F5 or f5, followed by anything after a slash); row is -1 for a pass
+	const std::string name = text.substr(0, text.find('/'));
+	if (name == "PA" or name == "pa" or name == "pass") {
+		row = -1;
+		col = -1;
+		return true;
+	}
+	if (name.size() < 2 or name.size() > 3) {
+		return false;
+	}
+	col = std::tolower((unsigned char) name[0]) - 'a';
+	row = 0;
+	for (size_t i = 1; i < name.size(); i++) {
+		if (not std::isdigit((unsigned char) name[i])) {
+			return false;
+		}
+		row = 10 * row + (name[i] - '0');
+	}
+	row--;
+	return row >= 0 and row < BOARD_SIZE and col >= 0 and col < BOARD_SIZE;
+}
+
+bool play_move(game_record& record, const piece p, const int row, const int col) {
+	// play (row, col) for p, if it is valid; a pass is valid when it is the turn of the opponent
+	// (the record passes by itself)
+	if (row < 0) {
+		return record.get_turn() != p;
+	}
+	if (record.get_turn() != p) {
+		return false;
+	}
+	const std::vector<std::tuple<int, int>> moves = record.get_game().valid_moves(p);
+	if (std::find(moves.begin(), moves.end(), std::make_tuple(row, col)) == moves.end()) {
+		return false;
+	}
+	record.play(row, col);
+	return true;
+}
+
+bool read_ggf(const std::string& ggf, game_record& record) {
+	// read the start board and the moves of a game; false (record unchanged) if it is not a valid game of BOARD_SIZE
+	game_record game;
+	bool board = false;
+	size_t i = 0;
+	while ((i = ggf.find('[', i)) != std::string::npos) {
+		const size_t end = ggf.find(']', i);
+		if (end == std::string::npos) {
+			return false;
+		}
+		// the tag is the upper case letters before the value
+		size_t start = i;
+		while (start > 0 and std::isupper((unsigned char) ggf[start - 1])) {
+			start--;
+		}
+		const std::string tag = ggf.substr(start, i - start);
+		const std::string value = ggf.substr(i + 1, end - i - 1);
+		i = end + 1;
+		if (tag == "BO") {
+			std::istringstream fields(value);
+			int size = 0;
+			fields >> size;
+			std::string position;
+			std::getline(fields, position);
+			othello_game start_board;
+			piece turn;
+			if (size != BOARD_SIZE or not start_board.set_position(position, turn)) {
+				return false;
+			}
+			game.reset(start_board, turn);
+			board = true;
+		} else if (tag == "B" or tag == "W") {
+			int row, col;
+			if (not board or not read_move(value, row, col) or not play_move(game, (tag == "B") ? piece::X : piece::O, row, col)) {
+				return false;
+			}
+		}
+	}
+	if (not board) {
+		return false;
+	}
+	record = std::move(game);
+	return true;
+}
+
+std::string nboard_move(const int row, const int col) {
+	if (row < 0) {
+		return "PA";
+	}
+	std::string name = move_name(row, col);
+	name[0] = (char) std::toupper((unsigned char) name[0]);
+	return name;
+}
+
+double nboard_eval(const search_result& result, const double score) {
+	// disc margin for the player to move: exact when solved, scaled from the probability of a win otherwise
+	return (result._solved) ? result._margin : (2. * score - 1.) * BOARD_SIZE * BOARD_SIZE;
+}
+
+//----------------------------------------------------------------------------
+// Scheduler
+// the searches of all the sessions share POOL: at most SERVER_SEARCHES run at
+// the same time, each with its share of the threads, the others wait in a
+// queue; the next search is the one of a player waiting for a move (go) before
+// any hint, then the one of the session which has used the least search time,
+// then the oldest; a go finding no free slot stops a running hint
+
+class nboard_session;
+
+struct search_request {
+	nboard_session *_session;
+	othello_game _othello;
+	piece _turn;
+	int _hints; // 0: go
+	int _move_time;
+	double _used; // search time already used by the session in milliseconds
+	long long _sequence; // order of submission
+};
+
+class search_scheduler {
+public:
+	// constructor: start the threads running the searches
+	search_scheduler(const int slots, const int queue_limit);
+	// destructor: stop and join the threads (the sessions are closed first)
+	~search_scheduler();
+	// getters
+	inline int get_threads_per_search() const {return std::max(1, NUMBER_PROCESSOR / (int) _threads.size());}
+	// helper functions
+	bool submit(const search_request& request); // queue request; false if it is a hint and the queue is full
+	bool cancel(const nboard_session *session, search_request &request); // remove the queued request of session, if any
+	void wait(const nboard_session *session); // wait for the end of the running search of session, if any
+private:
+	std::mutex _mutex;
+	std::condition_variable _work;
+	std::condition_variable _done;
+	std::vector<search_request> _queue;
+	std::vector<const search_request*> _running; // request run by each slot (nullptr: free)
+	std::vector<std::thread> _threads;
+	const int _queue_limit;
+	long long _sequence;
+	bool _shutdown;
+	void run(const int slot);
+	size_t next_request() const;
+};
+
+//----------------------------------------------------------------------------
+// Session
+// one game, searched by the scheduler; the commands that change the game, or
+// start a search, stop the search in progress (or queued) first
+
+class nboard_session {
+public:
+	// constructor: prefix is written before each reply (multi-session server)
+	nboard_session(search_scheduler& scheduler, std::ostream& output, std::mutex& output_mutex, const std::string& prefix);
+	~nboard_session() {stop();}
+	// return false when the session is over (quit)
+	bool command(const std::string& line);
+	// run a search of the session (called by the scheduler)
+	void search(const search_request& request);
+	// stop flag of the search of the session
+	inline void interrupt() {_stop = true;}
+private:
+	search_scheduler& _scheduler;
+	std::ostream& _output;
+	std::mutex& _output_mutex;
+	const std::string _prefix;
+	std::unique_ptr<othello_engine> _engine; // engine of the session (the trees of the tree search)
+	game_record _record;
+	int _number_path;
+	int _move_time;
+	long long _time_left; // game clock of the session in milliseconds, if GAME_TIME
+	double _used; // search time used by the session in milliseconds (fair share of the scheduler)
+	std::atomic<bool> _stop;
+	void send(const std::string& lines);
+	void stop();
+	void start(const int hints);
+	void new_game();
+	int move_time() const;
+	void send_hints(const search_result& result, const int hints, const int empty);
+};
+
+search_scheduler::search_scheduler(const int slots, const int queue_limit) : _running(slots, nullptr), _queue_limit(queue_limit), _sequence(0), _shutdown(false) {
+	for (int i = 0; i < slots; i++) {
+		_threads.push_back(std::thread(&search_scheduler::run, this, i));
+	}
+}
+
+search_scheduler::~search_scheduler() {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_shutdown = true;
+	}
+	_work.notify_all();
+	for (std::thread& t : _threads) {
+		t.join();
+	}
+}
+
+bool search_scheduler::submit(const search_request& request) {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (request._hints > 0 and (int) _queue.size() >= _queue_limit) {
+			return false;
+		}
+		_queue.push_back(request);
+		_queue.back()._sequence = _sequence++;
+		if (request._hints == 0 and std::find(_running.begin(), _running.end(), nullptr) == _running.end()) {
+			// no free slot: the oldest running hint gives way to the player waiting
+			const search_request *hint = nullptr;
+			for (const search_request *r : _running) {
+				if (r->_hints > 0 and (hint == nullptr or r->_sequence < hint->_sequence)) {
+					hint = r;
+				}
+			}
+			if (hint != nullptr) {
+				hint->_session->interrupt();
+			}
+		}
+	}
+	_work.notify_one();
+	return true;
+}
+
+bool search_scheduler::cancel(const nboard_session *session, search_request &request) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	for (size_t i = 0; i < _queue.size(); i++) {
+		if (_queue[i]._session == session) {
+			request = _queue[i];
+			_queue.erase(_queue.begin() + i);
+			return true;
+		}
+	}
+	return false;
+}
+
+void search_scheduler::wait(const nboard_session *session) {
+	std::unique_lock<std::mutex> lock(_mutex);
+	_done.wait(lock, [this, session] {
+		for (const search_request *r : _running) {
+			if (r != nullptr and r->_session == session) {
+				return false;
+			}
+		}
+		return true;
+	});
+}
+
+size_t search_scheduler::next_request() const {
+	// index in _queue of the next request to run: go first, then the least used session, then the oldest
+	size_t best = 0;
+	for (size_t i = 1; i < _queue.size(); i++) {
+		const search_request& r = _queue[i];
+		const search_request& b = _queue[best];
+		if (std::make_tuple(r._hints > 0, r._used, r._sequence) < std::make_tuple(b._hints > 0, b._used, b._sequence)) {
+			best = i;
+		}
+	}
+	return best;
+}
+
+void search_scheduler::run(const int slot) {
+	std::unique_lock<std::mutex> lock(_mutex);
+	while (true) {
+		_work.wait(lock, [this] {return _shutdown or not _queue.empty();});
+		if (_shutdown) {
+			return;
+		}
+		const size_t next = next_request();
+		const search_request request = _queue[next];
+		_queue.erase(_queue.begin() + next);
+		_running[slot] = &request;
+		lock.unlock();
+		request._session->search(request);
+		lock.lock();
+		_running[slot] = nullptr;
+		_done.notify_all();
+	}
+}
+
+nboard_session::nboard_session(search_scheduler& scheduler, std::ostream& output, std::mutex& output_mutex, const std::string& prefix) :
+	_scheduler(scheduler), _output(output), _output_mutex(output_mutex), _prefix(prefix), _engine(create_engine(BOARD_SIZE)),
+	_number_path(NUMBER_MONTE_CARLO_PATH), _move_time(MOVE_TIME), _time_left(1000LL * GAME_TIME), _used(0.), _stop(false) {
+}
+
+void nboard_session::send(const std::string& lines) {
+	// one line at a time, flushed at once: the GUI waits for it
+	std::lock_guard<std::mutex> lock(_output_mutex);
+	size_t start = 0;
+	while (start <= lines.size()) {
+		const size_t end = std::min(lines.find('\n', start), lines.size());
+		_output << _prefix << lines.substr(start, end - start) << '\n';
+		start = end + 1;
+	}
+	_output.flush();
+}
+
+void nboard_session::stop() {
+	// stop the search in progress, if any, and wait for its reply; a queued search is run at once, stopped
+	_stop = true;
+	search_request request;
+	if (_scheduler.cancel(this, request)) {
+		search(request);
+	}
+	_scheduler.wait(this);
+	_stop = false;
+}
+
+void nboard_session::new_game() {
+	_time_left = 1000LL * GAME_TIME;
+}
+
+int nboard_session::move_time() const {
+	// time of the next move: the time per move, within the share of the game clock of the session for its remaining moves
+	if (GAME_TIME <= 0) {
+		return _move_time;
+	}
+	const int moves_left = (_record.get_game().score_board(piece::EMPTY) + 1) / 2;
+	const int share = (int) std::max(1LL, _time_left / std::max(1, moves_left));
+	return (_move_time > 0) ? std::min(_move_time, share) : share;
+}
+
+void nboard_session::start(const int hints) {
+	// search the game in the background: go (hints = 0), or hint
+	stop();
+	if (_record.get_turn() == piece::EMPTY) {
+		send((hints == 0) ? "=== PA" : "status");
+		return;
+	}
+	const search_request request = {this, _record.get_game(), _record.get_turn(), hints, move_time(), _used, 0};
+	if (not _scheduler.submit(request)) {
+		send("status busy");
+		return;
+	}
+	send("status thinking");
+}
+
+void nboard_session::search(const search_request& request) {
+	// go: the book is played, and the best move is sent when the search is over (or stopped)
+	// hint: the hints best moves are sent after each report of the search
+	typedef std::chrono::duration<double, std::milli> milliseconds;
+	const int hints = request._hints;
+	thread_pool::set_urgent(hints == 0);
+	search_parameters parameters;
+	parameters._number_thread = _scheduler.get_threads_per_search();
+	parameters._number_path = _number_path;
+	parameters._ponder = nullptr;
+	parameters._stop = &_stop;
+	const search_clock::time_point start = search_clock::now();
+	const int empty = request._othello.score_board(piece::EMPTY);
+	search_clock::time_point sent = start - std::chrono::milliseconds(HINT_INTERVAL);
+	bool last_sent = false; // the last report was sent
+	if (hints > 0) {
+		parameters._book = nullptr;
+		parameters._report = [this, hints, empty, &sent, &last_sent](const search_result& result) {
+			const search_clock::time_point now = search_clock::now();
+			last_sent = now - sent >= std::chrono::milliseconds(HINT_INTERVAL);
+			if (last_sent) {
+				send_hints(result, hints, empty);
+				sent = now;
+			}
+		};
+	}
+	const search_result result = search_move(*_engine, parameters, request._othello, request._turn, request._move_time);
+	const double elapsed = milliseconds(search_clock::now() - start).count();
+	_used += elapsed;
+	if (hints > 0) {
+		if (result._row >= 0 and not last_sent) {
+			send_hints(result, hints, empty);
+		}
+		send("status");
+		return;
+	}
+	_time_left -= (long long) elapsed;
+	std::ostringstream line;
+	line << std::fixed << std::setprecision(2) << "=== " << nboard_move(result._row, result._col) << "/" << nboard_eval(result, result._score);
+	line << "/" << std::setprecision(3) << elapsed / 1000.;
+	send(line.str());
+}
+
+void nboard_session::send_hints(const search_result& result, const int hints, const int empty) {
+	// the hints best moves: the move chosen by the search, then the others by score; a solved position has only its best move
+	// nothing is sent without a move searched (a search stopped before it assessed any move)
+	if (result._row < 0 or (not result._solved and result._candidates.empty())) {
+		return;
+	}
+	std::vector<search_candidate> candidates = result._candidates;
+	if (result._solved) {
+		const search_candidate candidate = {result._row, result._col, 0, result._score};
+		candidates.assign(1, candidate);
+	}
+	std::sort(candidates.begin(), candidates.end(), [&result](const search_candidate& a, const search_candidate& b) {
+		const bool best_a = a._row == result._row and a._col == result._col;
+		const bool best_b = b._row == result._row and b._col == result._col;
+		return (best_a != best_b) ? best_a : a._score > b._score;
+	});
+	std::ostringstream lines;
+	lines << std::fixed << std::setprecision(2);
+	for (int i = 0; i < hints and i < (int) candidates.size(); i++) {
+		const search_candidate& c = candidates[i];
+		lines << ((i > 0) ? "\n" : "") << "search " << nboard_move(c._row, c._col) << " " << nboard_eval(result, c._score) << " 0 ";
+		if (result._solved) {
+			lines << empty << "@100%";
+		} else {
+			lines << c._paths;
+		}
+	}
+	send(lines.str());
+}
+
+bool nboard_session::command(const std::string& line) {
+	std::istringstream fields(line);
+	std::string name;
+	fields >> name;
+	if (name.empty()) {
+		return true;
+	}
+	if (name == "stop") {
+		stop();
+		return true;
+	}
+	if (name == "ping") {
+		std::string number;
+		fields >> number;
+		stop();
+		send("pong " + number);
+		return true;
+	}
+	// the other commands wait for the end of the search in progress
+	stop();
+	if (name == "quit") {
+		return false;
+	} else if (name == "nboard") {
+		send(std::string("set myname ") + SERVER_NAME);
+	} else if (name == "set") {
+		std::string key;
+		fields >> key;
+		std::string value;
+		std::getline(fields >> std::ws, value);
+		if (key == "game") {
+			if (read_ggf(value, _record)) {
+				new_game();
+			} else {
+				send("status invalid game");
+			}
+		} else if (key == "position") {
+			othello_game othello;
+			piece turn;
+			game_record record;
+			if (othello.set_position(value, turn)) {
+				_record.reset(othello, turn);
+				new_game();
+			} else if (record.set_transcript(value)) {
+				_record = std::move(record);
+				new_game();
+			} else {
+				send("status invalid position");
+			}
+		} else if (key == "depth") {
+			_number_path = std::max(1, std::atoi(value.c_str())) * DEPTH_PATHS;
+		} else if (key == "paths") {
+			_number_path = std::max(100, std::atoi(value.c_str()));
+		} else if (key == "time") {
+			_move_time = std::max(0, std::atoi(value.c_str()));
+		}
+		// other keys (contempt...) are ignored
+	} else if (name == "move") {
+		std::string move;
+		fields >> move;
+		int row, col;
+		// a pass is already played by the record
+		if (not read_move(move, row, col) or (row >= 0 and (_record.get_turn() == piece::EMPTY or not play_move(_record, _record.get_turn(), row, col)))) {
+			send("status invalid move " + move);
+		}
+	} else if (name == "go") {
+		start(0);
+	} else if (name == "hint") {
+		int hints = 1;
+		fields >> hints;
+		start(std::max(1, hints));
+	} else if (name == "learn") {
+		send("learned");
+	} else {
+		send("status unknown command " + name);
+	}
+	return true;
+}
+
+//----------------------------------------------------------------------------
+
+int main(int argc, char ** argv) {
+	if (argc >= 2 and std::string(argv[1]) == "help") {
+		std::cout << USAGE;
+		return 0;
+	}
+	init_server_variables(argc, argv);
+	init_engine();
+	thread_pool pool(NUMBER_PROCESSOR);
+	POOL = &pool;
+	search_scheduler scheduler(SERVER_SEARCHES, SERVER_QUEUE_FACTOR * SERVER_SEARCHES);
+	std::mutex output_mutex;
+	// one session without prefix, or the sessions named by the first word of each line
+	std::map<std::string, std::unique_ptr<nboard_session>> sessions;
+	if (SERVER_SESSIONS == 0) {
+		sessions[""] = std::unique_ptr<nboard_session>(new nboard_session(scheduler, std::cout, output_mutex, ""));
+	}
+	std::string line;
+	while (std::getline(std::cin, line)) {
+		if (not line.empty() and line.back() == '\r') {
+			line.pop_back();
+		}
+		std::string id;
+		if (SERVER_SESSIONS > 0) {
+			std::istringstream fields(line);
+			fields >> id;
+			if (id.empty()) {
+				continue;
+			}
+			std::getline(fields >> std::ws, line);
+			if (sessions.find(id) == sessions.end()) {
+				// admission control: a new session is refused once SERVER_SESSIONS are open
+				if ((int) sessions.size() >= SERVER_SESSIONS) {
+					std::lock_guard<std::mutex> lock(output_mutex);
+					std::cout << id << " status busy" << std::endl;
+					continue;
+				}
+				sessions[id] = std::unique_ptr<nboard_session>(new nboard_session(scheduler, std::cout, output_mutex, id + " "));
+			}
+		}
+		if (not sessions[id]->command(line)) {
+			sessions.erase(id);
+			if (SERVER_SESSIONS == 0) {
+				break;
+			}
+		}
+	}
+	sessions.clear();
+	return 0;
+}
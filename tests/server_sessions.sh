@@ -0,0 +1,47 @@
+#!/bin/sh
+# session tests of othello_server: a hint stopped before its first round of paths sends no
+# search line, whether it is stopped by a ping of its session or by the go of another session
+# which needs its search slot (2 sessions, 1 search at a time)
+# usage: tests/server_sessions.sh [othello_server]; exit status 0 if all the tests pass
+
+SERVER=${1:-./othello_server}
+OUTPUT=$(mktemp)
+FAILED=0
+
+check() {
+	# check <test> <grep pattern> <expected count>
+	COUNT=$(grep -c "$2" "$OUTPUT")
+	if [ "$COUNT" -ne "$3" ]; then
+		echo "FAILED: $1: $COUNT line(s) '$2' instead of $3"
+		cat "$OUTPUT"
+		FAILED=1
+	else
+		echo "ok: $1"
+	fi
+}
+
+# hint of 3 x 10^6 paths per move (a first round of seconds), stopped by ping at once
+(
+	printf "a nboard 2\na set position f5\na set paths 3000000\na hint 3\n"
+	sleep 0.5
+	printf "a ping 1\n"
+	sleep 0.5
+	printf "a quit\n"
+) | "$SERVER" 8 1 20000 F 0 14 64 - 1 2 1 0 > "$OUTPUT"
+check "hint stopped by ping: pong" "^a pong 1$" 1
+check "hint stopped by ping: no search line" "^a search" 0
+
+# hint of 3 x 10^6 paths per move (a first round of seconds) of session a, stopped by the go of session b
+(
+	printf "a nboard 2\nb nboard 2\na set position f5\nb set position f5\na set paths 3000000\nb set paths 2000\na hint 3\n"
+	sleep 0.5
+	printf "b go\n"
+	sleep 2
+	printf "a quit\nb quit\n"
+) | "$SERVER" 8 1 20000 F 0 14 64 - 1 2 1 0 > "$OUTPUT"
+check "hint stopped by the go of another session: move" "^b === [A-H][1-8]/" 1
+check "hint stopped by the go of another session: end of the hint" "^a status$" 1
+check "hint stopped by the go of another session: no search line" "^a search" 0
+
+rm -f "$OUTPUT"
+exit $FAILED